@@ -5,6 +5,7 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <functional>
+#include "Headless.h"
 
 class Application {
 private:
@@ -12,6 +13,9 @@ private:
     unsigned int width;
     unsigned int height;
     const char* title;
+    HeadlessOptions headless;
+    HeadlessTarget offscreen;
+    bool headlessPassed = true;
 
     static void framebuffer_size_callback_internal(GLFWwindow* window, int width, int height) {
         glViewport(0, 0, width, height);
@@ -21,7 +25,12 @@ public:
     Application(unsigned int w = 800, unsigned int h = 600, const char* windowTitle = "OpenGL Application")
         : width(w), height(h), title(windowTitle), window(nullptr) {}
 
-    bool initialize() {
+    // With headless options enabled there is no visible window: frames go to an
+    // offscreen framebuffer and run() renders a fixed number of them
+    bool initialize(const HeadlessOptions& headlessOptions = HeadlessOptions()) {
+        headless = headlessOptions;
+        if (headless.enabled) Headless::initHints();
+
         // Initialize GLFW
         if (!glfwInit()) {
             std::cout << "Failed to initialize GLFW" << std::endl;
@@ -38,7 +47,8 @@ public:
 #endif
 
         // Create window
-        window = glfwCreateWindow(width, height, title, NULL, NULL);
+        window = headless.enabled ? Headless::createWindow(width, height, title)
+            : glfwCreateWindow(width, height, title, NULL, NULL);
         if (window == NULL) {
             std::cout << "Failed to create GLFW window" << std::endl;
             glfwTerminate();
@@ -53,6 +63,11 @@ public:
             return false;
         }
 
+        if (headless.enabled && !offscreen.create(width, height)) {
+            std::cout << "Failed to create offscreen framebuffer" << std::endl;
+            return false;
+        }
+
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
 
@@ -63,6 +78,11 @@ public:
              std::function<void(float)> updateCallback, 
              std::function<void()> renderCallback) {
         
+        if (headless.enabled) {
+            runHeadless(setupCallback, updateCallback, renderCallback);
+            return;
+        }
+
         // Call setup once
         if (setupCallback) setupCallback();
 
@@ -91,7 +111,37 @@ public:
         }
     }
 
+    // Render a fixed number of frames offscreen with a fixed time step, so every
+    // run draws the same frames, then write the timings and the last frame
+    void runHeadless(std::function<void()> setupCallback,
+        std::function<void(float)> updateCallback,
+        std::function<void()> renderCallback) {
+
+        if (setupCallback) setupCallback();
+
+        const float deltaTime = 1.0f / 60.0f;
+        for (int frame = 0; frame < headless.frames; frame++) {
+            offscreen.beginFrame();
+
+            if (updateCallback) updateCallback(deltaTime);
+
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            if (renderCallback) renderCallback();
+
+            offscreen.endFrame();
+            glfwPollEvents();
+        }
+
+        headlessPassed = offscreen.finish(headless);
+    }
+
+    // For main(): 1 if a headless run failed its golden image or perf check
+    int exitCode() const { return headlessPassed ? 0 : 1; }
+
     void shutdown() {
+        offscreen.destroy();
         glfwTerminate();
     }
 
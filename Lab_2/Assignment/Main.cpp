@@ -9,6 +9,7 @@
 #include "Lamp.h"
 
 #include <iostream>
+#include <cstring>
 
 using namespace std;
 
@@ -62,6 +63,7 @@ void printUsage() {
 void setup() {
     // Initialize shaders and objects
     ourShader = new Shader("vertexShader.vs", "fragmentShader.fs");
+    ProgramCache::printSummary();
     cube = new Cube();
     room = new Boundary();
     teacherTable = new Table(2.5f, 1.2f, 0.8f, glm::vec3(0.3f, 0.2f, 0.15f));
@@ -178,10 +180,15 @@ void cleanup() {
     delete hangingLamp;
 }
 
-int main() {
+int main(int argc, char** argv) {
     Application app(SCR_WIDTH, SCR_HEIGHT, "Assignment: 3D Lab");
+    for (int i = 1; i < argc; i++) {
+        // Always compile shaders from source instead of using shader_cache/
+        if (strcmp(argv[i], "--no-shader-cache") == 0) ProgramCache::enabled() = false;
+    }
     
-    if (!app.initialize()) {
+    // --headless [frames] renders offscreen and writes timings and the last frame
+    if (!app.initialize(HeadlessOptions::parse(argc, argv))) {
         return -1;
     }
 
@@ -195,7 +202,7 @@ int main() {
 
     cleanup();
     
-    return 0;
+    return app.exitCode();
 }
 
 void processInput(GLFWwindow* window, float deltaTime)
@@ -0,0 +1,127 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Entries are keyed by a hash of the shader sources (after any defines were added)
+// and of the driver's vendor, renderer and version strings, so a driver update or
+// a different GPU never picks up a stale binary. The driver may still reject a
+// binary; Shader then compiles from source and replaces the entry.
+//
+// Needs GL 4.1 (or a 3.3 context that exposes it); otherwise load() and store()
+// do nothing and every program is compiled as before.
+namespace ProgramCache {
+    struct Stats {
+        int loaded = 0;      // programs restored from a binary
+        int compiled = 0;    // programs compiled from source
+        int rejected = 0;    // binaries the driver refused
+        double milliseconds = 0.0;   // total time spent building programs
+    };
+
+    inline bool& enabled() {
+        static bool on = true;
+        return on;
+    }
+
+    inline std::string& directory() {
+        static std::string path = "shader_cache";
+        return path;
+    }
+
+    inline Stats& stats() {
+        static Stats s;
+        return s;
+    }
+
+    inline bool supported() {
+        if (!enabled() || !GLAD_GL_VERSION_4_1 || !glGetProgramBinary || !glProgramBinary)
+            return false;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // FNV-1a, 64 bit
+    inline uint64_t hashText(const std::string& text, uint64_t hash = 14695981039346656037ull) {
+        for (unsigned char c : text)
+            hash = (hash ^ c) * 1099511628211ull;
+        return (hash ^ 0xff) * 1099511628211ull;   // separator, so "ab"+"c" != "a"+"bc"
+    }
+
+    inline uint64_t key(const std::string& vertexCode, const std::string& fragmentCode) {
+        uint64_t hash = hashText(vertexCode);
+        hash = hashText(fragmentCode, hash);
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* value = (const char*)glGetString(name);
+            hash = hashText(value ? value : "", hash);
+        }
+        return hash;
+    }
+
+    inline std::string pathFor(uint64_t key) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory() + "/" + name;
+    }
+
+    // Restore 'program' from the cache. False when there is no entry or the
+    // driver rejects it; the program must then be linked from source.
+    inline bool load(uint64_t key, unsigned int program) {
+        if (!supported()) return false;
+        std::ifstream file(pathFor(key), std::ios::binary);
+        if (!file) return false;
+
+        GLenum format = 0;
+        if (!file.read((char*)&format, sizeof(format))) return false;
+        std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (binary.empty()) return false;
+
+        glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            stats().rejected++;
+            return false;
+        }
+        stats().loaded++;
+        return true;
+    }
+
+    // Save a freshly linked program
+    inline void store(uint64_t key, unsigned int program) {
+        if (!supported()) return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+        std::ofstream file(pathFor(key), std::ios::binary);
+        if (!file) return;
+        file.write((const char*)&format, sizeof(format));
+        file.write(binary.data(), binary.size());
+    }
+
+    inline void printSummary() {
+        const Stats& s = stats();
+        std::cout << "Shaders: " << s.loaded << " loaded from " << directory() << "/, "
+            << s.compiled << " compiled" << (s.rejected ? " (" + std::to_string(s.rejected) + " binaries rejected)" : "")
+            << ", " << s.milliseconds << " ms"
+            << (!enabled() ? " (cache disabled)" : supported() ? "" : " (program binaries unavailable)") << std::endl;
+    }
+}
+
+#endif
@@ -9,6 +9,11 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "ProgramCache.h"
 
 class Shader
 {
@@ -44,10 +49,171 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
         }
+        // 2. restore the linked program from the binary cache, or compile it from source
+        auto buildStart = std::chrono::steady_clock::now();
+        ID = glCreateProgram();
+        uint64_t cacheKey = ProgramCache::key(vertexCode, fragmentCode);
+        if (!ProgramCache::load(cacheKey, ID))
+        {
+            compileAndLink(vertexCode, fragmentCode);
+            ProgramCache::store(cacheKey, ID);
+        }
+        ProgramCache::stats().milliseconds +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+        cacheUniformLocations();
+    }
+
+    void use() const
+    {
+        glUseProgram(ID);
+    }
+
+    // Returns the cached location of a uniform (-1 if the program has none).
+    // Resolve once and pass the result to the set* overloads that take a location.
+    int uniform(const char* name) const
+    {
+        if (uniformSlots.empty())
+            return -1;
+        unsigned int hash = hashName(name);
+        size_t mask = uniformSlots.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask)
+        {
+            const UniformSlot& slot = uniformSlots[i];
+            if (slot.location == EMPTY_SLOT)
+                return -1;
+            if (slot.hash == hash && slot.name == name)
+                return slot.location;
+        }
+    }
+
+    void setBool(int location, bool value) const
+    {
+        glUniform1i(location, (int)value);
+    }
+    void setBool(const char* name, bool value) const
+    {
+        setBool(uniform(name), value);
+    }
+    void setInt(int location, int value) const
+    {
+        glUniform1i(location, value);
+    }
+    void setInt(const char* name, int value) const
+    {
+        setInt(uniform(name), value);
+    }
+    void setFloat(int location, float value) const
+    {
+        glUniform1f(location, value);
+    }
+    void setFloat(const char* name, float value) const
+    {
+        setFloat(uniform(name), value);
+    }
+    void setVec3(int location, const glm::vec3& value) const
+    {
+        glUniform3fv(location, 1, &value[0]);
+    }
+    void setVec3(const char* name, const glm::vec3& value) const
+    {
+        setVec3(uniform(name), value);
+    }
+    void setVec3(int location, float x, float y, float z) const
+    {
+        glUniform3f(location, x, y, z);
+    }
+    void setVec3(const char* name, float x, float y, float z) const
+    {
+        setVec3(uniform(name), x, y, z);
+    }
+    void setMat4(int location, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4(const char* name, const glm::mat4& mat) const
+    {
+        setMat4(uniform(name), mat);
+    }
+
+private:
+    // Flat open-addressing table of active uniforms, built once after linking
+    struct UniformSlot
+    {
+        unsigned int hash;
+        int location;
+        std::string name;
+    };
+    static const int EMPTY_SLOT = -2;
+    std::vector<UniformSlot> uniformSlots;
+
+    // FNV-1a
+    static unsigned int hashName(const char* name)
+    {
+        unsigned int hash = 2166136261u;
+        for (; *name; ++name)
+            hash = (hash ^ (unsigned char)*name) * 16777619u;
+        return hash;
+    }
+
+    void insertUniform(const std::string& name, int location)
+    {
+        unsigned int hash = hashName(name.c_str());
+        size_t mask = uniformSlots.size() - 1;
+        size_t i = hash & mask;
+        while (uniformSlots[i].location != EMPTY_SLOT)
+            i = (i + 1) & mask;
+        uniformSlots[i] = { hash, location, name };
+    }
+
+    // Enumerate every active uniform once so the setters never query the driver
+    void cacheUniformLocations()
+    {
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::vector<std::pair<std::string, int>> found;
+        std::vector<char> buffer(maxLength + 1);
+        for (int i = 0; i < count; i++)
+        {
+            int size = 0;
+            unsigned int type = 0;
+            glGetActiveUniform(ID, i, (int)buffer.size(), nullptr, &size, &type, buffer.data());
+            std::string name = buffer.data();
+            int location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0)
+                continue; // member of a uniform block
+            found.push_back({ name, location });
+
+            // arrays are reported as "name[0]"; also register "name" and "name[i]"
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                std::string base = name.substr(0, name.size() - 3);
+                found.push_back({ base, location });
+                for (int e = 1; e < size; e++)
+                {
+                    std::string element = base + "[" + std::to_string(e) + "]";
+                    found.push_back({ element, glGetUniformLocation(ID, element.c_str()) });
+                }
+            }
+        }
+
+        // keep the load factor at or below one half
+        size_t capacity = 16;
+        while (capacity < found.size() * 2)
+            capacity *= 2;
+        uniformSlots.assign(capacity, { 0, EMPTY_SLOT, std::string() });
+        for (const auto& entry : found)
+            insertUniform(entry.first, entry.second);
+    }
+
+    // compile both stages and link them into ID
+    void compileAndLink(const std::string& vertexCode, const std::string& fragmentCode)
+    {
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
 
-        // 2. compile shaders
         unsigned int vertex, fragment;
 
         // vertex shader
@@ -63,7 +229,8 @@ public:
         checkCompileErrors(fragment, "FRAGMENT");
 
         // shader Program
-        ID = glCreateProgram();
+        if (ProgramCache::supported())
+            glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
@@ -71,39 +238,9 @@ public:
 
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        ProgramCache::stats().compiled++;
     }
 
-    void use() const
-    {
-        glUseProgram(ID);
-    }
-
-    void setBool(const std::string& name, bool value) const
-    {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-    }
-    void setInt(const std::string& name, int value) const
-    {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    void setFloat(const std::string& name, float value) const
-    {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    void setVec3(const std::string& name, const glm::vec3& value) const
-    {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-    }
-    void setVec3(const std::string& name, float x, float y, float z) const
-    {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
-    }
-    void setMat4(const std::string& name, const glm::mat4& mat) const
-    {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-    }
-
-private:
     void checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
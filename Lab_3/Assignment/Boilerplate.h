@@ -5,13 +5,45 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <functional>
+#include <algorithm>
+#include <semaphore>
+#include <thread>
+#include "Headless.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
 
+// run() advances the simulation in fixed ticks of 1 / tickRate seconds, however
+// fast frames are drawn, so animations behave the same at any frame rate and a
+// slow frame only means more ticks before the next draw. The render callback
+// should draw previous + (current - previous) * interpolationAlpha(), where
+// previous is the state before the last tick; that hides the steps between ticks.
 class Application {
 private:
     GLFWwindow* window;
     unsigned int width;
     unsigned int height;
     const char* title;
+    HeadlessOptions headless;
+    HeadlessTarget offscreen;
+    bool headlessPassed = true;
+    bool overlayLegendPrinted = false;
+    double lastTitleUpdate = 0.0;
+    double tickRate = 60.0;
+    double accumulator = 0.0;   // simulated time not yet covered by a tick
+    float alpha = 1.0f;
+
+    // A longer frame (a breakpoint, a window drag) is treated as this long, so the
+    // simulation slows down instead of running hundreds of ticks to catch up
+    static constexpr double MAX_FRAME_TIME = 0.25;
+    static constexpr double HEADLESS_FRAME_TIME = 1.0 / 60.0;
+
+    static inline bool keysCaptured = false;
+    static inline unsigned char keySnapshot[GLFW_KEY_LAST + 1] = {};
+
+    void captureKeys() {
+        for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; key++)
+            keySnapshot[key] = (unsigned char)glfwGetKey(window, key);
+    }
 
     static void framebuffer_size_callback_internal(GLFWwindow* window, int width, int height) {
         glViewport(0, 0, width, height);
@@ -22,7 +54,12 @@ public:
         : width(w), height(h), title(windowTitle), window(nullptr) {
     }
 
-    bool initialize() {
+    // With headless options enabled there is no visible window: frames go to an
+    // offscreen framebuffer and run() renders a fixed number of them
+    bool initialize(const HeadlessOptions& headlessOptions = HeadlessOptions()) {
+        headless = headlessOptions;
+        if (headless.enabled) Headless::initHints();
+
         // Initialize GLFW
         if (!glfwInit()) {
             std::cout << "Failed to initialize GLFW" << std::endl;
@@ -39,7 +76,8 @@ public:
 #endif
 
         // Create window
-        window = glfwCreateWindow(width, height, title, NULL, NULL);
+        window = headless.enabled ? Headless::createWindow(width, height, title)
+            : glfwCreateWindow(width, height, title, NULL, NULL);
         if (window == NULL) {
             std::cout << "Failed to create GLFW window" << std::endl;
             glfwTerminate();
@@ -54,6 +92,11 @@ public:
             return false;
         }
 
+        if (headless.enabled && !offscreen.create(width, height)) {
+            std::cout << "Failed to create offscreen framebuffer" << std::endl;
+            return false;
+        }
+
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
 
@@ -64,35 +107,202 @@ public:
         std::function<void(float)> updateCallback,
         std::function<void()> renderCallback) {
 
+        if (headless.enabled) {
+            runHeadless(setupCallback, updateCallback, renderCallback);
+            return;
+        }
+
         // Call setup once
         if (setupCallback) setupCallback();
 
-        float lastFrame = 0.0f;
+        double lastFrame = glfwGetTime();
 
         // Main render loop
         while (!glfwWindowShouldClose(window)) {
-            // Calculate delta time
-            float currentFrame = static_cast<float>(glfwGetTime());
-            float deltaTime = currentFrame - lastFrame;
+            PROFILE_ZONE("frame");
+
+            // Run the ticks the elapsed time covers
+            double currentFrame = glfwGetTime();
+            advance(currentFrame - lastFrame, updateCallback);
             lastFrame = currentFrame;
 
-            // Update logic
-            if (updateCallback) updateCallback(deltaTime);
+            renderFrame(renderCallback);
 
-            // Clear buffers
-            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            // Swap buffers and poll events
+            {
+                PROFILE_ZONE("swap");
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            }
+        }
+    }
 
-            // Render
-            if (renderCallback) renderCallback();
+    // Render a fixed number of frames offscreen, each 1/60 s apart in simulated
+    // time, so every run draws the same frames, then write the timings and the last frame
+    void runHeadless(std::function<void()> setupCallback,
+        std::function<void(float)> updateCallback,
+        std::function<void()> renderCallback) {
 
-            // Swap buffers and poll events
-            glfwSwapBuffers(window);
+        if (setupCallback) setupCallback();
+
+        for (int frame = 0; frame < headless.frames; frame++) {
+            PROFILE_ZONE("frame");
+            offscreen.beginFrame();
+            advance(HEADLESS_FRAME_TIME, updateCallback);
+            renderFrame(renderCallback);
+
+            {
+                PROFILE_ZONE("gpu finish");
+                offscreen.endFrame();
+            }
             glfwPollEvents();
         }
+        finishHeadless();
+    }
+
+    // Like run(), but the update ticks and recordCallback run on a second thread,
+    // one frame ahead: while this thread draws frame N, the other simulates and
+    // records frame N+1. recordCallback(slot) copies everything the renderer needs
+    // into render packet 'slot' (0 or 1), and renderCallback(slot) draws only from
+    // that packet, so the two threads never touch the same data. Update callbacks
+    // must read keys with getKey(); GLFW itself is only called from this thread.
+    void runPipelined(std::function<void()> setupCallback,
+        std::function<void(float)> updateCallback,
+        std::function<void(int)> recordCallback,
+        std::function<void(int)> renderCallback) {
+
+        if (setupCallback) setupCallback();
+
+        keysCaptured = true;
+        captureKeys();
+        double lastSimulated = glfwGetTime();
+        auto simulate = [&](int slot) {
+            PROFILE_ZONE("simulate");
+            double now = glfwGetTime();
+            advance(headless.enabled ? HEADLESS_FRAME_TIME : now - lastSimulated, updateCallback);
+            lastSimulated = now;
+            if (recordCallback) recordCallback(slot);
+        };
+
+        // The first packet is made before anything is drawn
+        simulate(0);
+
+        std::binary_semaphore startSimulation(0), simulationDone(0);
+        bool stopping = false;
+        std::thread updateThread([&]() {
+            if (Profiler::isEnabled()) Profiler::get().setThreadName("update");
+            int slot = 1;
+            while (true) {
+                startSimulation.acquire();
+                if (stopping) break;
+                simulate(slot);
+                slot ^= 1;
+                simulationDone.release();
+            }
+        });
+
+        int slot = 0;
+        for (int frame = 0; headless.enabled ? frame < headless.frames : !glfwWindowShouldClose(window); frame++) {
+            PROFILE_ZONE("frame");
+            if (headless.enabled) offscreen.beginFrame();
+
+            startSimulation.release();
+            renderFrame([&]() { if (renderCallback) renderCallback(slot); });
+            {
+                PROFILE_ZONE("wait for update");
+                simulationDone.acquire();
+            }
+
+            if (headless.enabled) {
+                PROFILE_ZONE("gpu finish");
+                offscreen.endFrame();
+            }
+            else {
+                PROFILE_ZONE("swap");
+                glfwSwapBuffers(window);
+            }
+            glfwPollEvents();
+            captureKeys();
+            slot ^= 1;
+        }
+
+        stopping = true;
+        startSimulation.release();
+        updateThread.join();
+        keysCaptured = false;
+
+        if (headless.enabled) finishHeadless();
+    }
+
+    // glfwGetKey() for update callbacks; under runPipelined() it reads the copy
+    // taken on the main thread before the frame was handed to the update thread
+    static int getKey(GLFWwindow* window, int key) {
+        if (keysCaptured) return keySnapshot[key];
+        return glfwGetKey(window, key);
+    }
+
+    // Ticks per second of the simulation (60 by default)
+    void setTickRate(double ticksPerSecond) {
+        if (ticksPerSecond > 0.0) tickRate = ticksPerSecond;
+    }
+    double getTickRate() const { return tickRate; }
+
+    // How far the clock is past the last tick, in ticks (0..1); blend factor for rendering
+    float interpolationAlpha() const { return alpha; }
+
+    // Add 'frameTime' seconds to the simulation clock and run every whole tick
+    // it completes; the remainder carries over to the next frame
+    void advance(double frameTime, const std::function<void(float)>& updateCallback) {
+        const double step = 1.0 / tickRate;
+        accumulator += std::min(frameTime, MAX_FRAME_TIME);
+        while (accumulator >= step) {
+            PROFILE_ZONE("update");
+            if (updateCallback) updateCallback((float)step);
+            accumulator -= step;
+        }
+        alpha = (float)(accumulator / step);
+    }
+
+    // Clear and draw one frame, bracketed for the GPU timers
+    void renderFrame(const std::function<void()>& renderCallback) {
+        PROFILE_ZONE("render");
+        GpuTimer::get().beginFrame();
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (renderCallback) renderCallback();
+        drawGpuOverlay();
+        GpuTimer::get().endFrame();
+    }
+
+    void finishHeadless() {
+        headlessPassed = offscreen.finish(headless);
+    }
+
+    // For main(): 1 if a headless run failed its golden image or perf check
+    int exitCode() const { return headlessPassed ? 0 : 1; }
+
+    // With GPU timers on: pass bars in the bottom-left corner, legend printed once,
+    // and the per-pass times in the window title about twice a second
+    void drawGpuOverlay() {
+        if (!GpuTimer::isEnabled()) return;
+        GpuTimer& timer = GpuTimer::get();
+        timer.drawOverlay(8, 8);
+        if (timer.latest().empty()) return;
+
+        if (!overlayLegendPrinted) {
+            timer.printLegend();
+            overlayLegendPrinted = true;
+        }
+        double now = glfwGetTime();
+        if (!headless.enabled && now - lastTitleUpdate > 0.5) {
+            glfwSetWindowTitle(window, (std::string(title) + " - " + timer.summary()).c_str());
+            lastTitleUpdate = now;
+        }
     }
 
     void shutdown() {
+        GpuTimer::get().reset();
+        offscreen.destroy();
         glfwTerminate();
     }
 
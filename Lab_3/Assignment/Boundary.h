@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
 #include "Cube.h"
+#include "SceneNode.h"
 
 class Boundary {
 public:
@@ -40,53 +41,53 @@ public:
         floorColor = fColor;
     }
 
-    // Draw floor
-    void drawFloor(Shader& shader, glm::mat4 parentModel = glm::mat4(1.0f)) {
+    // Build floor
+    void buildFloor(SceneNode* parent) {
         float halfWidth = roomWidth / 2.0f;
         float halfDepth = roomDepth / 2.0f;
-        cube.draw(shader, parentModel, -halfWidth, 0.0f, -halfDepth,
+        parent->addPart(cube.getMesh(), -halfWidth, 0.0f, -halfDepth,
             0.0f, 0.0f, 0.0f,
             roomWidth, wallThickness, roomDepth, floorColor);
     }
 
-    // Draw back wall
-    void drawBackWall(Shader& shader, glm::mat4 parentModel = glm::mat4(1.0f)) {
+    // Build back wall
+    void buildBackWall(SceneNode* parent) {
         float halfWidth = roomWidth / 2.0f;
         float halfDepth = roomDepth / 2.0f;
-        cube.draw(shader, parentModel, -halfWidth, 0.0f, -halfDepth,
+        parent->addPart(cube.getMesh(), -halfWidth, 0.0f, -halfDepth,
             0.0f, 0.0f, 0.0f,
             roomWidth, roomHeight, wallThickness, wallColor);
     }
 
-    // Draw left wall
-    void drawLeftWall(Shader& shader, glm::mat4 parentModel = glm::mat4(1.0f)) {
+    // Build left wall
+    void buildLeftWall(SceneNode* parent) {
         float halfWidth = roomWidth / 2.0f;
         float halfDepth = roomDepth / 2.0f;
-        cube.draw(shader, parentModel, -halfWidth, 0.0f, -halfDepth,
+        parent->addPart(cube.getMesh(), -halfWidth, 0.0f, -halfDepth,
             0.0f, 0.0f, 0.0f,
             wallThickness, roomHeight, roomDepth, wallColor);
     }
 
-    // Draw right wall
-    void drawRightWall(Shader& shader, glm::mat4 parentModel = glm::mat4(1.0f)) {
+    // Build right wall
+    void buildRightWall(SceneNode* parent) {
         float halfWidth = roomWidth / 2.0f;
         float halfDepth = roomDepth / 2.0f;
-        cube.draw(shader, parentModel, halfWidth - wallThickness, 0.0f, -halfDepth,
+        parent->addPart(cube.getMesh(), halfWidth - wallThickness, 0.0f, -halfDepth,
             0.0f, 0.0f, 0.0f,
             wallThickness, roomHeight, roomDepth, wallColor);
     }
 
-    // Draw all walls (back, left, right)
-    void drawWalls(Shader& shader, glm::mat4 parentModel = glm::mat4(1.0f)) {
-        drawBackWall(shader, parentModel);
-        drawLeftWall(shader, parentModel);
-        drawRightWall(shader, parentModel);
+    // Build all walls (back, left, right)
+    void buildWalls(SceneNode* parent) {
+        buildBackWall(parent);
+        buildLeftWall(parent);
+        buildRightWall(parent);
     }
 
-    // Draw complete room (floor + walls)
-    void drawRoom(Shader& shader, glm::mat4 parentModel = glm::mat4(1.0f)) {
-        drawFloor(shader, parentModel);
-        drawWalls(shader, parentModel);
+    // Build complete room (floor + walls)
+    void buildRoom(SceneNode* parent) {
+        buildFloor(parent);
+        buildWalls(parent);
     }
 };
 
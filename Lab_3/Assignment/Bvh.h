@@ -0,0 +1,335 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+#include "Frustum.h"
+
+// Bounding volume hierarchy over object boxes, for scenes too large to cull
+// with a linear pass (thousands of desks, a fleet of ships).
+//
+// build() splits each node with the surface area heuristic, evaluated over
+// BIN_COUNT centroid bins per axis instead of every object. update() moves one
+// object and refits only the nodes above it; the tree shape is kept, so after
+// large movements a rebuild gives tighter nodes. Queries visit object indices
+// (the positions in the array passed to build()).
+class Bvh {
+public:
+    static const int BIN_COUNT = 12;
+    static const int MAX_LEAF_SIZE = 4;
+    static const int MAX_DEPTH = 60;   // keeps the fixed traversal stacks below in bounds
+
+    struct Node {
+        Aabb bounds;
+        int first = 0;     // leaf: first entry of 'objects'; inner: left child (right = first + 1)
+        int count = 0;     // objects in a leaf, 0 for inner nodes
+        int parent = -1;
+    };
+
+    void build(const std::vector<Aabb>& boxes) {
+        objectBounds = boxes;
+        nodes.clear();
+        objects.resize(boxes.size());
+        leafOf.assign(boxes.size(), -1);
+        centroids.resize(boxes.size());
+        for (size_t i = 0; i < boxes.size(); i++) {
+            objects[i] = (int)i;
+            centroids[i] = boxes[i].center();
+        }
+        if (boxes.empty()) return;
+
+        nodes.reserve(boxes.size() * 2 / MAX_LEAF_SIZE + 1);
+        nodes.push_back(Node());
+        nodes[0].count = (int)boxes.size();
+
+        // Children are always appended after their parent, which refit() relies on
+        std::vector<std::pair<int, int>> stack(1, { 0, 1 });   // node, depth
+        while (!stack.empty()) {
+            auto [index, depth] = stack.back();
+            stack.pop_back();
+            int left = split(index, depth);
+            if (left >= 0) {
+                stack.push_back({ left, depth + 1 });
+                stack.push_back({ left + 1, depth + 1 });
+            }
+        }
+    }
+
+    // Move one object and grow or shrink the nodes above it
+    void update(int object, const Aabb& box) {
+        objectBounds[object] = box;
+        for (int index = leafOf[object]; index >= 0; index = nodes[index].parent)
+            recomputeBounds(index);
+    }
+
+    // Recompute every node from the current object boxes (after many updates)
+    void refit() {
+        for (int index = (int)nodes.size() - 1; index >= 0; index--)
+            recomputeBounds(index);
+    }
+
+    // visit(object) for every object whose box intersects the frustum. Nodes
+    // entirely inside are accepted without testing their objects.
+    template <typename Visit>
+    void queryFrustum(const Frustum& frustum, Visit&& visit) const {
+        if (nodes.empty()) return;
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            Frustum::Containment containment = frustum.classify(node.bounds);
+            if (containment == Frustum::OUTSIDE) continue;
+            if (containment == Frustum::INSIDE) {
+                visitSubtree(node, visit);
+                continue;
+            }
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; i++)
+                    if (frustum.intersects(objectBounds[objects[i]])) visit(objects[i]);
+            }
+            else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+
+    // visit(object) for every object whose box overlaps 'box'
+    template <typename Visit>
+    void queryOverlap(const Aabb& box, Visit&& visit) const {
+        query([&](const Aabb& bounds) { return box.overlaps(bounds); }, visit);
+    }
+
+    // visit(object) for every object whose box comes within 'radius' of 'center'
+    template <typename Visit>
+    void querySphere(const glm::vec3& center, float radius, Visit&& visit) const {
+        float radiusSquared = radius * radius;
+        query([&](const Aabb& bounds) {
+            glm::vec3 d = center - glm::clamp(center, bounds.min, bounds.max);
+            return glm::dot(d, d) <= radiusSquared;
+        }, visit);
+    }
+
+    // Nearest object box hit by the ray closer than maxDistance, or -1. The
+    // distance to the box is written to 'distance'; picking exact triangles is
+    // up to the caller. Children are visited near-first so far subtrees are pruned.
+    int raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance,
+        float maxDistance = INFINITY) const {
+        if (nodes.empty()) return -1;
+        glm::vec3 inverse = 1.0f / direction;
+        int hit = -1;
+        float best = maxDistance;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (rayBox(origin, inverse, node.bounds, best) >= best) continue;
+
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; i++) {
+                    float t = rayBox(origin, inverse, objectBounds[objects[i]], best);
+                    if (t < best) {
+                        best = t;
+                        hit = objects[i];
+                    }
+                }
+                continue;
+            }
+
+            float tLeft = rayBox(origin, inverse, nodes[node.first].bounds, best);
+            float tRight = rayBox(origin, inverse, nodes[node.first + 1].bounds, best);
+            // Push the farther child first so the nearer one is popped next
+            if (tLeft <= tRight) {
+                if (tRight < best) stack[top++] = node.first + 1;
+                if (tLeft < best) stack[top++] = node.first;
+            }
+            else {
+                if (tLeft < best) stack[top++] = node.first;
+                if (tRight < best) stack[top++] = node.first + 1;
+            }
+        }
+        if (hit >= 0) distance = best;
+        return hit;
+    }
+
+    const std::vector<Node>& getNodes() const { return nodes; }
+    size_t objectCount() const { return objectBounds.size(); }
+
+    int depth() const { return nodes.empty() ? 0 : depthOf(0); }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<int> objects;          // object indices, grouped by leaf
+    std::vector<int> leafOf;           // object -> leaf node
+    std::vector<Aabb> objectBounds;
+    std::vector<glm::vec3> centroids;
+
+    // Split node 'index' at 'depth' (holding objects[first, first + count)) if the SAH
+    // says it pays off. Returns the new left child, or -1 for a leaf.
+    int split(int index, int depth) {
+        Node& node = nodes[index];
+        node.bounds = Aabb();
+        Aabb centroidBounds;
+        for (int i = node.first; i < node.first + node.count; i++) {
+            node.bounds.add(objectBounds[objects[i]]);
+            centroidBounds.add(centroids[objects[i]]);
+        }
+
+        if (node.count > MAX_LEAF_SIZE) {
+            int axis = -1, bin = 0;
+            float bestCost = findSplit(node, centroidBounds, axis, bin);
+            // A leaf when splitting does not pay off, unless it would be too big
+            bool worthSplitting = bestCost < node.count * node.bounds.surfaceArea() || node.count > 4 * MAX_LEAF_SIZE;
+            if (axis >= 0 && worthSplitting && depth < MAX_DEPTH) {
+                float lo = centroidBounds.min[axis];
+                float scale = BIN_COUNT / (centroidBounds.max[axis] - lo);
+                int* begin = objects.data() + node.first;
+                int* middle = std::partition(begin, begin + node.count, [&](int object) {
+                    return std::min(BIN_COUNT - 1, (int)((centroids[object][axis] - lo) * scale)) < bin;
+                });
+                int leftCount = (int)(middle - begin);
+
+                if (leftCount > 0 && leftCount < node.count) {
+                    int left = (int)nodes.size();
+                    Node leftNode, rightNode;
+                    leftNode.first = node.first;
+                    leftNode.count = leftCount;
+                    leftNode.parent = index;
+                    rightNode.first = node.first + leftCount;
+                    rightNode.count = node.count - leftCount;
+                    rightNode.parent = index;
+
+                    nodes[index].first = left;   // 'node' is invalidated by the push_back below
+                    nodes[index].count = 0;
+                    nodes.push_back(leftNode);
+                    nodes.push_back(rightNode);
+                    return left;
+                }
+            }
+        }
+
+        for (int i = node.first; i < node.first + node.count; i++)
+            leafOf[objects[i]] = index;
+        return -1;
+    }
+
+    // Cheapest binned split over all three axes: cost = area(left) * count(left)
+    // + area(right) * count(right). Objects go left when their bin < 'bin'.
+    float findSplit(const Node& node, const Aabb& centroidBounds, int& bestAxis, int& bestBin) const {
+        float bestCost = INFINITY;
+        for (int axis = 0; axis < 3; axis++) {
+            float lo = centroidBounds.min[axis];
+            float extent = centroidBounds.max[axis] - lo;
+            if (extent <= 0.0f) continue;
+            float scale = BIN_COUNT / extent;
+
+            Aabb binBounds[BIN_COUNT];
+            int binCounts[BIN_COUNT] = {};
+            for (int i = node.first; i < node.first + node.count; i++) {
+                int object = objects[i];
+                int b = std::min(BIN_COUNT - 1, (int)((centroids[object][axis] - lo) * scale));
+                binCounts[b]++;
+                binBounds[b].add(objectBounds[object]);
+            }
+
+            // Sweep from the right for the right-hand areas, then from the left
+            float rightArea[BIN_COUNT];
+            int rightCount[BIN_COUNT];
+            Aabb accumulated;
+            int count = 0;
+            for (int b = BIN_COUNT - 1; b > 0; b--) {
+                accumulated.add(binBounds[b]);
+                count += binCounts[b];
+                rightArea[b] = accumulated.surfaceArea();
+                rightCount[b] = count;
+            }
+
+            accumulated = Aabb();
+            count = 0;
+            for (int b = 1; b < BIN_COUNT; b++) {
+                accumulated.add(binBounds[b - 1]);
+                count += binCounts[b - 1];
+                if (count == 0 || rightCount[b] == 0) continue;
+                float cost = accumulated.surfaceArea() * count + rightArea[b] * rightCount[b];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+        return bestCost;
+    }
+
+    void recomputeBounds(int index) {
+        Node& node = nodes[index];
+        node.bounds = Aabb();
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++)
+                node.bounds.add(objectBounds[objects[i]]);
+        }
+        else {
+            node.bounds.add(nodes[node.first].bounds);
+            node.bounds.add(nodes[node.first + 1].bounds);
+        }
+    }
+
+    template <typename Visit>
+    void visitSubtree(const Node& node, Visit& visit) const {
+        if (node.count > 0) {
+            for (int i = node.first; i < node.first + node.count; i++)
+                visit(objects[i]);
+            return;
+        }
+        visitSubtree(nodes[node.first], visit);
+        visitSubtree(nodes[node.first + 1], visit);
+    }
+
+    // Depth-first walk of every node accepted by 'accept', testing leaf objects with it too
+    template <typename Accept, typename Visit>
+    void query(Accept&& accept, Visit& visit) const {
+        if (nodes.empty()) return;
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!accept(node.bounds)) continue;
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; i++)
+                    if (accept(objectBounds[objects[i]])) visit(objects[i]);
+            }
+            else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+
+    // Entry distance of the ray into 'box' (0 when starting inside), or
+    // INFINITY when it misses or enters beyond 'limit'
+    static float rayBox(const glm::vec3& origin, const glm::vec3& inverse, const Aabb& box, float limit) {
+        glm::vec3 t0 = (box.min - origin) * inverse;
+        glm::vec3 t1 = (box.max - origin) * inverse;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, limit));
+        return enter <= exit ? enter : INFINITY;
+    }
+
+    int depthOf(int index) const {
+        const Node& node = nodes[index];
+        if (node.count > 0) return 1;
+        return 1 + std::max(depthOf(node.first), depthOf(node.first + 1));
+    }
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
 #include "Cube.h"
+#include "SceneNode.h"
 
 class Chair {
 public:
@@ -44,23 +45,20 @@ public:
         color = chairColor;
     }
 
-    // Draw the complete chair with transformations
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz,
+    // Build the complete chair under parent; returns its base node
+    SceneNode* build(SceneNode* parent, float tx, float ty, float tz,
         float rx = 0.0f, float ry = 0.0f, float rz = 0.0f) {
 
         // Create base transformation for the entire chair
-        glm::mat4 chairBase = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        chairBase = glm::rotate(chairBase, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-        chairBase = glm::rotate(chairBase, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-        chairBase = glm::rotate(chairBase, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
+        SceneNode* chairBase = parent->addChild(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz));
 
         // Draw seat
-        cube.draw(shader, chairBase, 0.0f, seatHeight, 0.0f,
+        chairBase->addPart(cube.getMesh(), 0.0f, seatHeight, 0.0f,
             0.0f, 0.0f, 0.0f,
             seatWidth, seatThickness, seatDepth, color);
 
         // Draw backrest (at the back of the seat)
-        cube.draw(shader, chairBase, 0.0f, seatHeight + seatThickness, seatDepth - backrestThickness,
+        chairBase->addPart(cube.getMesh(), 0.0f, seatHeight + seatThickness, seatDepth - backrestThickness,
             0.0f, 0.0f, 0.0f,
             seatWidth, backrestHeight, backrestThickness, color);
 
@@ -68,30 +66,31 @@ public:
         float inset = 0.02f;
 
         // Front-left leg
-        cube.draw(shader, chairBase, inset, 0.0f, inset,
+        chairBase->addPart(cube.getMesh(), inset, 0.0f, inset,
             0.0f, 0.0f, 0.0f,
             legThickness, seatHeight, legThickness, color);
 
         // Front-right leg
-        cube.draw(shader, chairBase, seatWidth - inset - legThickness, 0.0f, inset,
+        chairBase->addPart(cube.getMesh(), seatWidth - inset - legThickness, 0.0f, inset,
             0.0f, 0.0f, 0.0f,
             legThickness, seatHeight, legThickness, color);
 
         // Back-left leg (extends to support backrest)
-        cube.draw(shader, chairBase, inset, 0.0f, seatDepth - inset - legThickness,
+        chairBase->addPart(cube.getMesh(), inset, 0.0f, seatDepth - inset - legThickness,
             0.0f, 0.0f, 0.0f,
             legThickness, seatHeight + seatThickness + backrestHeight, legThickness, color);
 
         // Back-right leg (extends to support backrest)
-        cube.draw(shader, chairBase, seatWidth - inset - legThickness, 0.0f, seatDepth - inset - legThickness,
+        chairBase->addPart(cube.getMesh(), seatWidth - inset - legThickness, 0.0f, seatDepth - inset - legThickness,
             0.0f, 0.0f, 0.0f,
             legThickness, seatHeight + seatThickness + backrestHeight, legThickness, color);
+
+        return chairBase;
     }
 
-    // Alternative draw method with separate position and rotation vectors
-    void draw(Shader& shader, glm::vec3 position, glm::vec3 rotation = glm::vec3(0.0f)) {
-        glm::mat4 identity = glm::mat4(1.0f);
-        draw(shader, identity, position.x, position.y, position.z,
+    // Alternative build method with separate position and rotation vectors
+    SceneNode* build(SceneNode* parent, glm::vec3 position, glm::vec3 rotation = glm::vec3(0.0f)) {
+        return build(parent, position.x, position.y, position.z,
             rotation.x, rotation.y, rotation.z);
     }
 };
@@ -0,0 +1,260 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "shader.h"
+
+// A point light as the application describes it (world space)
+struct PointLightData {
+    glm::vec3 position;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+    float k_c;
+    float k_l;
+    float k_q;
+};
+
+// Clustered forward lighting.
+// Every frame the point lights are binned into view-space froxels (a GRID_X x GRID_Y
+// screen tile grid, GRID_Z exponential depth slices). Each cluster stores an
+// (offset, count) pair into a flat light index list. The light data, cluster grid
+// and index list reach the fragment shader through buffer textures, so it only
+// loops over the lights that can touch its cluster.
+class LightClusterGrid {
+public:
+    // Must match CLUSTER_X / CLUSTER_Y / CLUSTER_Z in fragmentShader.fs
+    static const int GRID_X = 16;
+    static const int GRID_Y = 9;
+    static const int GRID_Z = 24;
+    static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+    // Texture units used by the three buffer textures
+    static const int LIGHT_DATA_UNIT = 1;
+    static const int CLUSTER_GRID_UNIT = 2;
+    static const int LIGHT_INDEX_UNIT = 3;
+
+    // Locations of the per-view uniforms apply() sets, looked up once per program
+    struct Uniforms {
+        int viewportRect = -1;
+        int clusterNear = -1;
+        int clusterSliceScale = -1;
+
+        static Uniforms locate(const Shader& shader) {
+            Uniforms uniforms;
+            uniforms.viewportRect = shader.uniform("viewportRect");
+            uniforms.clusterNear = shader.uniform("clusterNear");
+            uniforms.clusterSliceScale = shader.uniform("clusterSliceScale");
+            return uniforms;
+        }
+    };
+
+    // A light stops being binned where its contribution drops below this
+    constexpr static float CUTOFF_INTENSITY = 1.0f / 256.0f;
+
+    LightClusterGrid() {
+        glGenBuffers(1, &lightDataBuffer);
+        glGenBuffers(1, &clusterGridBuffer);
+        glGenBuffers(1, &lightIndexBuffer);
+        glGenTextures(1, &lightDataTexture);
+        glGenTextures(1, &clusterGridTexture);
+        glGenTextures(1, &lightIndexTexture);
+
+        // Buffer textures need storage before they are attached
+        std::vector<float> empty(4, 0.0f);
+        allocate(lightDataBuffer, lightDataTexture, GL_RGBA32F, empty.data(), sizeof(float) * 4);
+        allocate(clusterGridBuffer, clusterGridTexture, GL_RG32UI, empty.data(), sizeof(unsigned int) * 2);
+        allocate(lightIndexBuffer, lightIndexTexture, GL_R32UI, empty.data(), sizeof(unsigned int));
+
+        clusterCounts.resize(CLUSTER_COUNT);
+        clusterGrid.resize(CLUSTER_COUNT * 2);
+    }
+
+    ~LightClusterGrid() {
+        glDeleteTextures(1, &lightDataTexture);
+        glDeleteTextures(1, &clusterGridTexture);
+        glDeleteTextures(1, &lightIndexTexture);
+        glDeleteBuffers(1, &lightDataBuffer);
+        glDeleteBuffers(1, &clusterGridBuffer);
+        glDeleteBuffers(1, &lightIndexBuffer);
+    }
+
+    // Connect the shader's samplers to our texture units (shader must be in use)
+    void bindTo(const Shader& shader) const {
+        shader.setInt("lightData", LIGHT_DATA_UNIT);
+        shader.setInt("clusterGrid", CLUSTER_GRID_UNIT);
+        shader.setInt("lightIndices", LIGHT_INDEX_UNIT);
+    }
+
+    // Upload world-space light data (four RGBA32F texels per light) once per frame
+    void uploadLights(const std::vector<PointLightData>& lights) {
+        worldPositions.resize(lights.size());
+        radii.resize(lights.size());
+        texels.resize(lights.size() * 16);
+
+        for (size_t i = 0; i < lights.size(); i++) {
+            const PointLightData& l = lights[i];
+            worldPositions[i] = l.position;
+            radii[i] = influenceRadius(l);
+
+            float* t = &texels[i * 16];
+            t[0] = l.position.x; t[1] = l.position.y; t[2] = l.position.z; t[3] = l.k_c;
+            t[4] = l.ambient.x;  t[5] = l.ambient.y;  t[6] = l.ambient.z;  t[7] = l.k_l;
+            t[8] = l.diffuse.x;  t[9] = l.diffuse.y;  t[10] = l.diffuse.z; t[11] = l.k_q;
+            t[12] = l.specular.x; t[13] = l.specular.y; t[14] = l.specular.z; t[15] = radii[i];
+        }
+
+        if (!texels.empty())
+            upload(lightDataBuffer, texels.data(), texels.size() * sizeof(float));
+    }
+
+    // Bin the uploaded lights for one view and upload the cluster grid and index list
+    void build(const glm::mat4& view, const glm::mat4& projection, float zNear, float zFar) {
+        nearPlane = zNear;
+        farPlane = zFar;
+        sliceScale = GRID_Z / std::log(zFar / zNear);
+
+        std::fill(clusterCounts.begin(), clusterCounts.end(), 0u);
+        pairs.clear();
+
+        for (size_t i = 0; i < worldPositions.size(); i++) {
+            glm::vec3 p = glm::vec3(view * glm::vec4(worldPositions[i], 1.0f));
+            float r = radii[i];
+            float depthMin = -p.z - r;
+            float depthMax = -p.z + r;
+            if (depthMax < zNear || depthMin > zFar)
+                continue;
+
+            int z0 = slice(std::max(depthMin, zNear));
+            int z1 = slice(std::min(depthMax, zFar));
+
+            int x0 = 0, x1 = GRID_X - 1, y0 = 0, y1 = GRID_Y - 1;
+            if (depthMin > zNear && !screenRect(p, r, projection, x0, x1, y0, y1))
+                continue;
+
+            for (int z = z0; z <= z1; z++)
+                for (int y = y0; y <= y1; y++)
+                    for (int x = x0; x <= x1; x++) {
+                        unsigned int cluster = (z * GRID_Y + y) * GRID_X + x;
+                        clusterCounts[cluster]++;
+                        pairs.push_back({ cluster, (unsigned int)i });
+                    }
+        }
+
+        // Counting sort of (cluster, light) pairs into a flat index list
+        unsigned int offset = 0;
+        maxLightsPerCluster = 0;
+        for (int c = 0; c < CLUSTER_COUNT; c++) {
+            clusterGrid[c * 2 + 0] = offset;
+            clusterGrid[c * 2 + 1] = 0;
+            offset += clusterCounts[c];
+            maxLightsPerCluster = std::max(maxLightsPerCluster, clusterCounts[c]);
+        }
+        lightIndices.resize(std::max<size_t>(pairs.size(), 1));
+        for (const auto& pair : pairs) {
+            unsigned int& count = clusterGrid[pair.first * 2 + 1];
+            lightIndices[clusterGrid[pair.first * 2] + count] = pair.second;
+            count++;
+        }
+
+        upload(clusterGridBuffer, clusterGrid.data(), clusterGrid.size() * sizeof(unsigned int));
+        upload(lightIndexBuffer, lightIndices.data(), lightIndices.size() * sizeof(unsigned int));
+    }
+
+    // Bind the buffer textures and the per-view cluster parameters (shader must be in use)
+    void apply(const Shader& shader, const Uniforms& uniforms, int viewportX, int viewportY, int viewportW, int viewportH) const {
+        glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, lightDataTexture);
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, clusterGridTexture);
+        glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, lightIndexTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        shader.setVec4(uniforms.viewportRect, (float)viewportX, (float)viewportY, (float)viewportW, (float)viewportH);
+        shader.setFloat(uniforms.clusterNear, nearPlane);
+        shader.setFloat(uniforms.clusterSliceScale, sliceScale);
+    }
+
+    // Light-cluster pairs written by the last build() (a measure of binning cost)
+    size_t lastIndexCount() const { return pairs.size(); }
+    unsigned int lastMaxLightsPerCluster() const { return maxLightsPerCluster; }
+
+    // Distance at which a light's strongest channel falls below CUTOFF_INTENSITY
+    static float influenceRadius(const PointLightData& l) {
+        glm::vec3 total = l.ambient + l.diffuse + l.specular;
+        float peak = std::max(total.x, std::max(total.y, total.z));
+        float c = l.k_c - peak / CUTOFF_INTENSITY;
+        if (c >= 0.0f)
+            return 0.0f;
+        if (l.k_q > 0.0f)
+            return (-l.k_l + std::sqrt(l.k_l * l.k_l - 4.0f * l.k_q * c)) / (2.0f * l.k_q);
+        if (l.k_l > 0.0f)
+            return -c / l.k_l;
+        return 1e30f;
+    }
+
+private:
+    unsigned int lightDataBuffer, clusterGridBuffer, lightIndexBuffer;
+    unsigned int lightDataTexture, clusterGridTexture, lightIndexTexture;
+
+    std::vector<glm::vec3> worldPositions;
+    std::vector<float> radii;
+    std::vector<float> texels;
+    std::vector<unsigned int> clusterCounts;
+    std::vector<unsigned int> clusterGrid;
+    std::vector<unsigned int> lightIndices;
+    std::vector<std::pair<unsigned int, unsigned int>> pairs;
+    unsigned int maxLightsPerCluster = 0;
+
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+    float sliceScale = 1.0f;
+
+    int slice(float depth) const {
+        int z = (int)std::floor(std::log(depth / nearPlane) * sliceScale);
+        return std::clamp(z, 0, GRID_Z - 1);
+    }
+
+    // Tile range covered by the projected view-space bounds of a sphere in front of the near plane
+    static bool screenRect(const glm::vec3& p, float r, const glm::mat4& projection, int& x0, int& x1, int& y0, int& y1) {
+        glm::vec2 lo(1.0f), hi(-1.0f);
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec3 c = p + glm::vec3((corner & 1) ? r : -r, (corner & 2) ? r : -r, (corner & 4) ? r : -r);
+            glm::vec4 clip = projection * glm::vec4(c, 1.0f);
+            glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            lo = glm::min(lo, ndc);
+            hi = glm::max(hi, ndc);
+        }
+        if (hi.x < -1.0f || hi.y < -1.0f || lo.x > 1.0f || lo.y > 1.0f)
+            return false;
+
+        x0 = std::clamp((int)std::floor((lo.x * 0.5f + 0.5f) * GRID_X), 0, GRID_X - 1);
+        x1 = std::clamp((int)std::floor((hi.x * 0.5f + 0.5f) * GRID_X), 0, GRID_X - 1);
+        y0 = std::clamp((int)std::floor((lo.y * 0.5f + 0.5f) * GRID_Y), 0, GRID_Y - 1);
+        y1 = std::clamp((int)std::floor((hi.y * 0.5f + 0.5f) * GRID_Y), 0, GRID_Y - 1);
+        return true;
+    }
+
+    static void allocate(unsigned int buffer, unsigned int texture, GLenum format, const void* data, size_t size) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Orphan and refill; the texture keeps pointing at the same buffer object
+    static void upload(unsigned int buffer, const void* data, size_t size) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+
+#endif
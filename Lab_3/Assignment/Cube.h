@@ -6,7 +6,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include "shader.h"
+#include "MeshCache.h"
+#include "RenderQueue.h"
 
 class Cube {
 public:
@@ -14,42 +15,45 @@ public:
     glm::mat4 model;
 
     Cube() {
-        setUpCube();
+        mesh = MeshCache::get().acquire(MeshKey(MESH_CUBE), buildCube);
         model = glm::mat4(1.0f);
         color = glm::vec3(1.0f);
     }
 
     ~Cube() {
-        glDeleteVertexArrays(1, &cubeVAO);
-        glDeleteBuffers(1, &cubeVBO);
-        glDeleteBuffers(1, &cubeEBO);
+        MeshCache::get().release(mesh);
     }
 
-    // Draw with explicit transformations
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+    // Record a draw with explicit transformations (submitted later by the render queue)
+    void draw(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
         glm::mat4 t = glm::translate(parentModel, glm::vec3(tx, ty, tz));
         glm::mat4 rX = glm::rotate(t, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
         glm::mat4 rY = glm::rotate(rX, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
         glm::mat4 rZ = glm::rotate(rY, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
         glm::mat4 m = glm::scale(rZ, glm::vec3(sx, sy, sz));
 
-        shader.setMat4("model", m);
-        
-        // Set material properties based on color
-        shader.setVec3("material.ambient", colorVec * 0.3f);
-        shader.setVec3("material.diffuse", colorVec);
-        shader.setVec3("material.specular", glm::vec3(0.3f, 0.3f, 0.3f));
-        shader.setFloat("material.shininess", 32.0f);
+        record(mesh, m, colorVec);
+    }
 
-        glBindVertexArray(cubeVAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    // Record a draw with a ready-made model matrix (used by the scene graph)
+    static void record(const Mesh* mesh, const glm::mat4& model, glm::vec3 colorVec) {
+        DrawList& list = RenderQueue::get().recordingList();
+        list.resize(list.size() + 1);
+        record(list, list.size() - 1, mesh, model, colorVec);
     }
 
+    // Fill draw 'index' of a presized list (lets threads record in parallel)
+    static void record(DrawList& list, size_t index, const Mesh* mesh, const glm::mat4& model, glm::vec3 colorVec) {
+        // Material properties based on color, stored with the draw
+        list.set(index, mesh->range, model, colorVec * 0.3f, colorVec, glm::vec3(0.3f, 0.3f, 0.3f), 32.0f);
+    }
+
+    Mesh* getMesh() const { return mesh; }
+
 private:
-    unsigned int cubeVAO, cubeVBO, cubeEBO;
+    Mesh* mesh;
 
-    void setUpCube() {
+    static void buildCube(MeshData& data) {
         // Cube vertices with positions and normals
         // Each face has 4 vertices with the same normal
         float vertices[] = {
@@ -107,25 +111,8 @@ private:
             20, 22, 21,  22, 20, 23
         };
 
-        glGenVertexArrays(1, &cubeVAO);
-        glGenBuffers(1, &cubeVBO);
-        glGenBuffers(1, &cubeEBO);
-
-        glBindVertexArray(cubeVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-        // Position attribute (location = 0)
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        
-        // Normal attribute (location = 1)
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glBindVertexArray(0);
+        data.vertices.assign(vertices, vertices + sizeof(vertices) / sizeof(float));
+        data.indices.assign(indices, indices + sizeof(indices) / sizeof(unsigned int));
     }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SSE2 1
+#endif
+
+// Boxes as centers and half extents, one array per component, so four boxes
+// load into one SSE register per component
+struct BoundsSoA {
+    std::vector<float> cx, cy, cz;
+    std::vector<float> ex, ey, ez;
+
+    size_t size() const { return cx.size(); }
+
+    void push_back(const Aabb& box) {
+        glm::vec3 c = box.center(), e = box.extents();
+        cx.push_back(c.x); cy.push_back(c.y); cz.push_back(c.z);
+        ex.push_back(e.x); ey.push_back(e.y); ez.push_back(e.z);
+    }
+
+    void clear() {
+        for (std::vector<float>* v : { &cx, &cy, &cz, &ex, &ey, &ez })
+            v->clear();
+    }
+
+    void resize(size_t count) {
+        for (std::vector<float>* v : { &cx, &cy, &cz, &ex, &ey, &ez })
+            v->resize(count);
+    }
+
+    void set(size_t i, const Aabb& box) {
+        glm::vec3 c = box.center(), e = box.extents();
+        cx[i] = c.x; cy[i] = c.y; cz[i] = c.z;
+        ex[i] = e.x; ey[i] = e.y; ez[i] = e.z;
+    }
+};
+
+// The six clip planes of a view-projection matrix (Gribb/Hartmann), normals
+// pointing inwards. A box is culled when it lies entirely behind one plane;
+// boxes near a frustum corner may pass although they are outside (conservative).
+class Frustum {
+public:
+    glm::vec4 planes[6];
+
+    Frustum() {}
+
+    explicit Frustum(const glm::mat4& viewProjection) {
+        glm::vec4 rowX = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 rowY = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 rowZ = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 rowW = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        planes[0] = rowW + rowX;  // left
+        planes[1] = rowW - rowX;  // right
+        planes[2] = rowW + rowY;  // bottom
+        planes[3] = rowW - rowY;  // top
+        planes[4] = rowW + rowZ;  // near
+        planes[5] = rowW - rowZ;  // far
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    enum Containment { OUTSIDE, INTERSECTS, INSIDE };
+
+    // INSIDE when the box is in front of every plane, so everything within it
+    // is visible without further tests
+    Containment classify(const Aabb& box) const {
+        if (box.empty()) return OUTSIDE;
+        glm::vec3 c = box.center(), e = box.extents();
+        Containment result = INSIDE;
+        for (const glm::vec4& plane : planes) {
+            float distance = glm::dot(glm::vec3(plane), c) + plane.w;
+            float radius = glm::dot(glm::abs(glm::vec3(plane)), e);
+            if (distance + radius < 0.0f) return OUTSIDE;
+            if (distance - radius < 0.0f) result = INTERSECTS;
+        }
+        return result;
+    }
+
+    bool intersects(const Aabb& box) const {
+        if (box.empty()) return false;
+        glm::vec3 c = box.center(), e = box.extents();
+        for (const glm::vec4& plane : planes) {
+            float distance = glm::dot(glm::vec3(plane), c) + plane.w;
+            float radius = glm::dot(glm::abs(glm::vec3(plane)), e);
+            if (distance + radius < 0.0f) return false;
+        }
+        return true;
+    }
+
+    // visible[i] = 1 if box i intersects the frustum, else 0. The SSE2 path
+    // tests four boxes per iteration against all six planes. Returns the
+    // number of visible boxes.
+    size_t cull(const BoundsSoA& boxes, std::vector<unsigned char>& visible) const {
+        size_t count = boxes.size();
+        visible.resize(count);
+        size_t i = 0;
+        size_t visibleCount = 0;
+
+#ifdef FRUSTUM_SSE2
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 nx[6], ny[6], nz[6], nw[6], ax[6], ay[6], az[6];
+        for (int p = 0; p < 6; p++) {
+            nx[p] = _mm_set1_ps(planes[p].x);
+            ny[p] = _mm_set1_ps(planes[p].y);
+            nz[p] = _mm_set1_ps(planes[p].z);
+            nw[p] = _mm_set1_ps(planes[p].w);
+            ax[p] = _mm_and_ps(nx[p], absMask);
+            ay[p] = _mm_and_ps(ny[p], absMask);
+            az[p] = _mm_and_ps(nz[p], absMask);
+        }
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 cx = _mm_loadu_ps(&boxes.cx[i]), cy = _mm_loadu_ps(&boxes.cy[i]), cz = _mm_loadu_ps(&boxes.cz[i]);
+            __m128 ex = _mm_loadu_ps(&boxes.ex[i]), ey = _mm_loadu_ps(&boxes.ey[i]), ez = _mm_loadu_ps(&boxes.ez[i]);
+
+            // Lanes that end up set are behind at least one plane
+            __m128 outside = _mm_setzero_ps();
+            for (int p = 0; p < 6; p++) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)),
+                    _mm_add_ps(_mm_mul_ps(nz[p], cz), nw[p]));
+                __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+
+            int mask = _mm_movemask_ps(outside);
+            for (int lane = 0; lane < 4; lane++) {
+                visible[i + lane] = (mask >> lane) & 1 ? 0 : 1;
+                visibleCount += visible[i + lane];
+            }
+        }
+#endif
+
+        for (; i < count; i++) {
+            Aabb box;
+            box.min = glm::vec3(boxes.cx[i] - boxes.ex[i], boxes.cy[i] - boxes.ey[i], boxes.cz[i] - boxes.ez[i]);
+            box.max = glm::vec3(boxes.cx[i] + boxes.ex[i], boxes.cy[i] + boxes.ey[i], boxes.cz[i] + boxes.ez[i]);
+            visible[i] = intersects(box) ? 1 : 0;
+            visibleCount += visible[i];
+        }
+        return visibleCount;
+    }
+};
+
+#endif
@@ -0,0 +1,277 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Profiler.h"
+
+// GPU timings per render pass:
+//
+//     {
+//         GPU_ZONE("isometric viewport");
+//         ...draw...
+//     }
+//
+// GPU_ZONE opens a PROFILE_ZONE and brackets the pass with two GL_TIMESTAMP
+// queries (glQueryCounter), so passes may nest. Queries live in a ring of
+// FRAMES_IN_FLIGHT frames and a frame is only read back when its slot comes
+// round again and every result reports GL_QUERY_RESULT_AVAILABLE, so reading
+// never stalls the pipeline. Resolved passes go to the profiler's "GPU" track
+// next to the CPU zones, to an optional CSV log, and to the overlay.
+class GpuTimer {
+public:
+    static const int FRAMES_IN_FLIGHT = 4;
+
+    // One resolved pass
+    struct PassTiming {
+        const char* name;
+        int depth;
+        double gpuMs;
+        double cpuMs;
+    };
+
+    static GpuTimer& get() {
+        static GpuTimer timer;
+        return timer;
+    }
+
+    static void setEnabled(bool on) { enabled = on; }
+    static bool isEnabled() { return enabled; }
+
+    // Append "frame,pass,depth,gpu_ms,cpu_ms" lines for every resolved pass
+    bool openLog(const std::string& path) {
+        log.open(path);
+        if (!log) return false;
+        log << "frame,pass,depth,gpu_ms,cpu_ms\n";
+        return true;
+    }
+
+    // Call once per frame before the first pass
+    void beginFrame() {
+        if (!enabled) return;
+        if (!calibrated) calibrate();
+
+        // Read back every older frame whose results are already there
+        for (int i = 1; i < FRAMES_IN_FLIGHT; i++)
+            resolve(frames[(current + i) % FRAMES_IN_FLIGHT]);
+
+        // This slot is about to be reused; results that never arrived are dropped
+        Frame& frame = frames[current];
+        if (frame.pending) droppedFrames++;
+        frame.used = 0;
+        frame.pending = true;
+        frame.index = frameCounter++;
+        depth = 0;
+        inFrame = true;
+    }
+
+    void endFrame() {
+        if (!enabled) return;
+        current = (current + 1) % FRAMES_IN_FLIGHT;
+        inFrame = false;
+    }
+
+    // Passes outside beginFrame()/endFrame() are not timed (returns -1)
+    int beginPass(const char* name) {
+        if (!inFrame) return -1;
+        Frame& frame = frames[current];
+        if (frame.used == frame.passes.size()) {
+            Pass pass;
+            glGenQueries(2, pass.queries);
+            frame.passes.push_back(pass);
+        }
+        int index = (int)frame.used++;
+        Pass& pass = frame.passes[index];
+        pass.name = name;
+        pass.depth = depth++;
+        pass.cpuStartNs = Profiler::get().now();
+        glQueryCounter(pass.queries[0], GL_TIMESTAMP);
+        return index;
+    }
+
+    void endPass(int index) {
+        Pass& pass = frames[current].passes[index];
+        glQueryCounter(pass.queries[1], GL_TIMESTAMP);
+        pass.cpuEndNs = Profiler::get().now();
+        depth--;
+    }
+
+    // Passes of the most recently resolved frame, in the order they began
+    const std::vector<PassTiming>& latest() const { return latestTimings; }
+    long long latestFrame() const { return latestFrameIndex; }
+    int dropped() const { return droppedFrames; }
+
+    // One line per top-level pass, e.g. for the window title
+    std::string summary() const {
+        std::string text = "GPU";
+        char buffer[96];
+        for (const PassTiming& timing : latestTimings) {
+            if (timing.depth > 0) continue;
+            snprintf(buffer, sizeof(buffer), " | %s %.2f ms", timing.name, timing.gpuMs);
+            text += buffer;
+        }
+        return text;
+    }
+
+    // Horizontal bar per pass (pixelsPerMs wide per millisecond) stacked upwards
+    // from (x, y), drawn with scissored clears so no shader or buffer state changes.
+    // A thin white tick marks 16.7 ms.
+    void drawOverlay(int x, int y, float pixelsPerMs = 20.0f, int barHeight = 6) const {
+        static const float palette[][3] = {
+            { 0.90f, 0.30f, 0.25f }, { 0.25f, 0.70f, 0.35f }, { 0.25f, 0.50f, 0.90f },
+            { 0.95f, 0.75f, 0.20f }, { 0.70f, 0.35f, 0.85f }, { 0.20f, 0.80f, 0.80f }
+        };
+
+        GLboolean scissorWasEnabled = glIsEnabled(GL_SCISSOR_TEST);
+        GLfloat clearColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        glEnable(GL_SCISSOR_TEST);
+
+        int row = 0;
+        for (size_t i = 0; i < latestTimings.size(); i++) {
+            const PassTiming& timing = latestTimings[i];
+            int width = (int)(timing.gpuMs * pixelsPerMs) + 1;
+            const float* color = palette[i % 6];
+            glScissor(x + timing.depth * 4, y + row * (barHeight + 2), width, barHeight);
+            glClearColor(color[0], color[1], color[2], 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            row++;
+        }
+
+        glScissor(x + (int)(16.7f * pixelsPerMs), y, 1, row * (barHeight + 2));
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        if (!scissorWasEnabled) glDisable(GL_SCISSOR_TEST);
+    }
+
+    // Print which overlay bar is which pass (bars are colored in pass order)
+    void printLegend() const {
+        static const char* colors[] = { "red", "green", "blue", "yellow", "purple", "cyan" };
+        std::cout << "GPU overlay bars, bottom to top:";
+        for (size_t i = 0; i < latestTimings.size(); i++)
+            std::cout << (i ? ", " : " ") << colors[i % 6] << " = " << latestTimings[i].name;
+        std::cout << std::endl;
+    }
+
+    void reset() {
+        for (Frame& frame : frames) {
+            for (Pass& pass : frame.passes)
+                glDeleteQueries(2, pass.queries);
+            frame.passes.clear();
+            frame.used = 0;
+            frame.pending = false;
+        }
+        if (log.is_open()) log.close();
+    }
+
+private:
+    struct Pass {
+        const char* name = nullptr;
+        int depth = 0;
+        unsigned int queries[2] = { 0, 0 };
+        uint64_t cpuStartNs = 0;
+        uint64_t cpuEndNs = 0;
+    };
+
+    struct Frame {
+        std::vector<Pass> passes;
+        size_t used = 0;
+        bool pending = false;
+        long long index = 0;
+    };
+
+    static inline bool enabled = false;
+
+    Frame frames[FRAMES_IN_FLIGHT];
+    int current = 0;
+    int depth = 0;
+    bool inFrame = false;
+    long long frameCounter = 0;
+    long long latestFrameIndex = -1;
+    int droppedFrames = 0;
+    std::vector<PassTiming> latestTimings;
+    std::ofstream log;
+
+    // GPU timestamp + offset = profiler time
+    bool calibrated = false;
+    int64_t gpuToProfilerNs = 0;
+    ProfileThreadBuffer* track = nullptr;
+
+    GpuTimer() {}
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void calibrate() {
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuToProfilerNs = (int64_t)Profiler::get().now() - (int64_t)gpuNow;
+        track = Profiler::get().createTrack("GPU");
+        calibrated = true;
+    }
+
+    // Read a frame's queries if all of them are available; never waits
+    void resolve(Frame& frame) {
+        if (!frame.pending) return;
+        if (frame.used > 0) {
+            GLint available = 0;
+            glGetQueryObjectiv(frame.passes[frame.used - 1].queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return;
+        }
+
+        latestTimings.clear();
+        for (size_t i = 0; i < frame.used; i++) {
+            const Pass& pass = frame.passes[i];
+            GLuint64 start = 0, end = 0;
+            glGetQueryObjectui64v(pass.queries[0], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(pass.queries[1], GL_QUERY_RESULT, &end);
+
+            PassTiming timing = { pass.name, pass.depth, (end - start) / 1e6,
+                (pass.cpuEndNs - pass.cpuStartNs) / 1e6 };
+            latestTimings.push_back(timing);
+
+            if (Profiler::isEnabled())
+                track->push(pass.name, start + gpuToProfilerNs, end + gpuToProfilerNs);
+            if (log.is_open()) {
+                log << frame.index << "," << pass.name << "," << pass.depth << ","
+                    << timing.gpuMs << "," << timing.cpuMs << "\n";
+            }
+        }
+        latestFrameIndex = frame.index;
+        frame.pending = false;
+    }
+};
+
+// RAII marker behind GPU_ZONE
+class GpuZone {
+public:
+    explicit GpuZone(const char* name) {
+        if (GpuTimer::isEnabled())
+            index = GpuTimer::get().beginPass(name);
+    }
+
+    ~GpuZone() {
+        if (index >= 0)
+            GpuTimer::get().endPass(index);
+    }
+
+private:
+    int index = -1;
+
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+};
+
+#ifdef PROFILER_COMPILED_OUT
+#define GPU_ZONE(name)
+#else
+#define GPU_ZONE(name) PROFILE_ZONE(name); GpuZone PROFILE_CONCAT(gpuZone, __LINE__)(name)
+#endif
+
+#endif
@@ -0,0 +1,378 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include "Png.h"
+
+// Command line switches for offscreen runs (CI, benchmarks):
+//   --headless [frames]  render a fixed number of frames (default 120) without a window
+//   --frame-out <path>   final framebuffer as a binary PPM, or PNG for a .png path (default headless_frame.ppm)
+//   --timings <path>     per-frame timings as CSV (default headless_timings.csv)
+// and for regression runs, which fail (exit code 1) when a check does not pass:
+//   --golden <png>           compare the final frame with this reference image
+//   --golden-tolerance <n>   per-channel difference still counted as equal (default 8)
+//   --golden-max-bad <pct>   share of pixels allowed past the tolerance (default 0.5)
+//   --diff-out <path>        differing pixels of a failed comparison (default headless_diff.ppm)
+//   --perf-json <path>       frame time percentiles as JSON
+//   --perf-baseline <json>   fail if p95 frame time is more than --perf-threshold
+//                            percent (default 10) above the one stored here
+//   --require-baseline       fail when the perf baseline file is missing
+//   --update-golden          write the golden image and perf baseline instead of checking them
+//   --update-perf-baseline   write only the perf baseline; the golden image is still checked
+//   --regression             the checks above against golden/frame.png and golden/perf.json
+struct HeadlessOptions {
+    bool enabled = false;
+    int frames = 120;
+    std::string imagePath = "headless_frame.ppm";
+    std::string timingsPath = "headless_timings.csv";
+
+    std::string goldenPath;
+    int goldenTolerance = 8;
+    double goldenMaxBadPercent = 0.5;
+    std::string diffPath = "headless_diff.ppm";
+    std::string perfPath;
+    std::string perfBaselinePath;
+    double perfThresholdPercent = 10.0;
+    bool requireBaseline = false;
+    bool updateGolden = false;
+    bool updatePerfBaseline = false;
+
+    static HeadlessOptions parse(int argc, char** argv) {
+        HeadlessOptions options;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--headless") == 0) {
+                options.enabled = true;
+                if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                    options.frames = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--frame-out") == 0 && i + 1 < argc) {
+                options.imagePath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--timings") == 0 && i + 1 < argc) {
+                options.timingsPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+                options.goldenPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--golden-tolerance") == 0 && i + 1 < argc) {
+                options.goldenTolerance = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--golden-max-bad") == 0 && i + 1 < argc) {
+                options.goldenMaxBadPercent = atof(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--diff-out") == 0 && i + 1 < argc) {
+                options.diffPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--perf-json") == 0 && i + 1 < argc) {
+                options.perfPath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--perf-baseline") == 0 && i + 1 < argc) {
+                options.perfBaselinePath = argv[++i];
+            }
+            else if (strcmp(argv[i], "--perf-threshold") == 0 && i + 1 < argc) {
+                options.perfThresholdPercent = atof(argv[++i]);
+            }
+            else if (strcmp(argv[i], "--require-baseline") == 0) {
+                options.requireBaseline = true;
+            }
+            else if (strcmp(argv[i], "--update-golden") == 0) {
+                options.updateGolden = true;
+            }
+            else if (strcmp(argv[i], "--update-perf-baseline") == 0) {
+                options.updatePerfBaseline = true;
+            }
+            else if (strcmp(argv[i], "--regression") == 0) {
+                options.enabled = true;
+                if (options.goldenPath.empty()) options.goldenPath = "golden/frame.png";
+                if (options.perfBaselinePath.empty()) options.perfBaselinePath = "golden/perf.json";
+                if (options.perfPath.empty()) options.perfPath = "headless_perf.json";
+            }
+        }
+        return options;
+    }
+};
+
+namespace Headless {
+    // Call before glfwInit(): GLFW's null platform needs no display server
+    inline void initHints() {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+
+    // Invisible window with a surfaceless EGL context, or OSMesa where EGL is
+    // missing. On a machine without a GPU Mesa serves both with llvmpipe.
+    inline GLFWwindow* createWindow(int width, int height, const char* title) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        GLFWwindow* window = glfwCreateWindow(width, height, title, NULL, NULL);
+        if (window == NULL) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = glfwCreateWindow(width, height, title, NULL, NULL);
+        }
+        return window;
+    }
+}
+
+// Offscreen framebuffer that stands in for the window's default framebuffer,
+// plus per-frame timing, an image of the last frame and the regression checks
+class HeadlessTarget {
+public:
+    bool create(int w, int h) {
+        width = w;
+        height = h;
+
+        glGenFramebuffers(1, &FBO);
+        glGenRenderbuffers(1, &colorRBO);
+        glGenRenderbuffers(1, &depthRBO);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+        glViewport(0, 0, width, height);
+
+        return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+
+    void destroy() {
+        if (FBO) {
+            glDeleteFramebuffers(1, &FBO);
+            glDeleteRenderbuffers(1, &colorRBO);
+            glDeleteRenderbuffers(1, &depthRBO);
+        }
+        FBO = colorRBO = depthRBO = 0;
+    }
+
+    void beginFrame() {
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        frameStart = std::chrono::steady_clock::now();
+    }
+
+    // Waits for the GPU, so the frame time covers the whole frame and not just
+    // the CPU side of issuing it
+    void endFrame() {
+        auto submitted = std::chrono::steady_clock::now();
+        glFinish();
+        auto finished = std::chrono::steady_clock::now();
+        cpuTimes.push_back(std::chrono::duration<double, std::milli>(submitted - frameStart).count());
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(finished - frameStart).count());
+    }
+
+    bool writeTimings(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file) return false;
+        file << "frame,cpu_ms,frame_ms\n";
+        for (size_t i = 0; i < frameTimes.size(); i++)
+            file << i << "," << cpuTimes[i] << "," << frameTimes[i] << "\n";
+        return true;
+    }
+
+    // RGB, top row first
+    std::vector<unsigned char> readPixels() const {
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+        std::vector<unsigned char> flipped(pixels.size());
+        size_t stride = (size_t)width * 3;
+        for (int y = 0; y < height; y++)
+            memcpy(&flipped[y * stride], &pixels[(size_t)(height - 1 - y) * stride], stride);
+        return flipped;
+    }
+
+    // PNG when the path ends in .png, binary PPM otherwise
+    bool writeImage(const std::string& path) const {
+        std::vector<unsigned char> pixels = readPixels();
+        if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0)
+            return Png::write(path, pixels, width, height);
+        return writePpm(path, pixels, width, height);
+    }
+
+    static bool writePpm(const std::string& path, const std::vector<unsigned char>& pixels, int w, int h) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+        file << "P6\n" << w << " " << h << "\n255\n";
+        file.write((const char*)pixels.data(), (std::streamsize)pixels.size());
+        return true;
+    }
+
+    // Frame time percentiles (nearest rank), in milliseconds
+    struct Percentiles {
+        double avg = 0.0, p50 = 0.0, p95 = 0.0, p99 = 0.0, max = 0.0;
+    };
+
+    static Percentiles percentiles(std::vector<double> times) {
+        Percentiles p;
+        if (times.empty()) return p;
+        std::sort(times.begin(), times.end());
+        auto rank = [&](double q) { return times[std::min(times.size() - 1, (size_t)std::ceil(q * times.size()) - 1)]; };
+        for (double t : times) p.avg += t;
+        p.avg /= times.size();
+        p.p50 = rank(0.50);
+        p.p95 = rank(0.95);
+        p.p99 = rank(0.99);
+        p.max = times.back();
+        return p;
+    }
+
+    bool writePerfJson(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file) return false;
+        auto object = [&](const Percentiles& p) {
+            file << "{ \"avg\": " << p.avg << ", \"p50\": " << p.p50 << ", \"p95\": " << p.p95
+                << ", \"p99\": " << p.p99 << ", \"max\": " << p.max << " }";
+        };
+        file << "{\n  \"frames\": " << frameTimes.size() << ",\n  \"width\": " << width
+            << ",\n  \"height\": " << height << ",\n  \"cpu_ms\": ";
+        object(percentiles(cpuTimes));
+        file << ",\n  \"frame_ms\": ";
+        object(percentiles(frameTimes));
+        file << "\n}\n";
+        return true;
+    }
+
+    // Compare the final frame with a golden PNG; on a mismatch the differing
+    // pixels are written in red over a darkened copy of the frame
+    bool compareGolden(const HeadlessOptions& options) const {
+        std::vector<unsigned char> golden;
+        int goldenWidth = 0, goldenHeight = 0;
+        if (!Png::read(options.goldenPath, golden, goldenWidth, goldenHeight)) {
+            std::cout << "Golden: cannot read " << options.goldenPath << " (write it with --update-golden)" << std::endl;
+            return false;
+        }
+        if (goldenWidth != width || goldenHeight != height) {
+            std::cout << "Golden: " << options.goldenPath << " is " << goldenWidth << "x" << goldenHeight
+                << ", the frame is " << width << "x" << height << std::endl;
+            return false;
+        }
+
+        std::vector<unsigned char> frame = readPixels();
+        std::vector<unsigned char> diff(frame.size());
+        size_t bad = 0;
+        int maxDifference = 0;
+        for (size_t i = 0; i < frame.size(); i += 3) {
+            int difference = 0;
+            for (int c = 0; c < 3; c++)
+                difference = std::max(difference, std::abs((int)frame[i + c] - (int)golden[i + c]));
+            maxDifference = std::max(maxDifference, difference);
+            bool mismatch = difference > options.goldenTolerance;
+            if (mismatch) bad++;
+            diff[i] = mismatch ? 255 : frame[i] / 4;
+            diff[i + 1] = mismatch ? 0 : frame[i + 1] / 4;
+            diff[i + 2] = mismatch ? 0 : frame[i + 2] / 4;
+        }
+
+        double badPercent = 100.0 * bad / ((size_t)width * height);
+        bool passed = badPercent <= options.goldenMaxBadPercent;
+        std::cout << "Golden: " << bad << " pixels (" << badPercent << "%) differ by more than "
+            << options.goldenTolerance << ", largest difference " << maxDifference << ": "
+            << (passed ? "passed" : "FAILED") << std::endl;
+        if (!passed && writePpm(options.diffPath, diff, width, height))
+            std::cout << "Golden: differences written to " << options.diffPath << std::endl;
+        return passed;
+    }
+
+    // Fail when p95 frame time is more than the threshold above the baseline's.
+    // The baseline is a file from writePerfJson(); a missing one only fails
+    // with --require-baseline.
+    bool comparePerfBaseline(const HeadlessOptions& options) const {
+        std::ifstream file(options.perfBaselinePath);
+        if (!file) {
+            std::cout << "Perf: no baseline at " << options.perfBaselinePath << " (write it with --update-perf-baseline)"
+                << (options.requireBaseline ? ": FAILED" : "") << std::endl;
+            return !options.requireBaseline;
+        }
+        std::stringstream text;
+        text << file.rdbuf();
+        std::string json = text.str();
+        size_t section = json.find("\"frame_ms\"");
+        size_t key = section == std::string::npos ? section : json.find("\"p95\":", section);
+        if (key == std::string::npos) {
+            std::cout << "Perf: no frame_ms p95 in " << options.perfBaselinePath << std::endl;
+            return false;
+        }
+        double baseline = atof(json.c_str() + key + 6);
+        double current = percentiles(frameTimes).p95;
+        double change = baseline > 0.0 ? 100.0 * (current - baseline) / baseline : 0.0;
+        bool passed = change <= options.perfThresholdPercent;
+        std::cout << "Perf: p95 frame time " << current << " ms, baseline " << baseline << " ms ("
+            << (change >= 0.0 ? "+" : "") << change << "%, limit +" << options.perfThresholdPercent << "%): "
+            << (passed ? "passed" : "FAILED") << std::endl;
+        return passed;
+    }
+
+    // Everything a headless run ends with: summary, timings, the last frame,
+    // then the golden and perf checks. Returns false if a check failed.
+    bool finish(const HeadlessOptions& options) const {
+        printSummary();
+        if (!writeTimings(options.timingsPath))
+            std::cout << "Failed to write " << options.timingsPath << std::endl;
+        if (!writeImage(options.imagePath))
+            std::cout << "Failed to write " << options.imagePath << std::endl;
+        if (!options.perfPath.empty() && !writePerfJson(options.perfPath))
+            std::cout << "Failed to write " << options.perfPath << std::endl;
+
+        if (options.updateGolden) {
+            if (!options.goldenPath.empty() && !Png::write(options.goldenPath, readPixels(), width, height)) {
+                std::cout << "Failed to write " << options.goldenPath << std::endl;
+                return false;
+            }
+            if (!options.perfBaselinePath.empty() && !writePerfJson(options.perfBaselinePath)) {
+                std::cout << "Failed to write " << options.perfBaselinePath << std::endl;
+                return false;
+            }
+            std::cout << "Updated " << options.goldenPath << " " << options.perfBaselinePath << std::endl;
+            return true;
+        }
+
+        bool passed = true;
+        if (!options.goldenPath.empty()) passed = compareGolden(options) && passed;
+        if (options.updatePerfBaseline) {
+            // Frame times belong to the machine; the reference image does not,
+            // so it is never rewritten here
+            if (options.perfBaselinePath.empty() || !writePerfJson(options.perfBaselinePath)) {
+                std::cout << "Failed to write the perf baseline " << options.perfBaselinePath << std::endl;
+                return false;
+            }
+            std::cout << "Updated " << options.perfBaselinePath << std::endl;
+        }
+        else if (!options.perfBaselinePath.empty()) {
+            passed = comparePerfBaseline(options) && passed;
+        }
+        return passed;
+    }
+
+    void printSummary() const {
+        if (frameTimes.empty()) return;
+        double total = 0.0;
+        for (double t : frameTimes) total += t;
+        std::cout << "Headless: " << frameTimes.size() << " frames at " << width << "x" << height
+            << ", frame time avg " << total / frameTimes.size() << " ms, min "
+            << *std::min_element(frameTimes.begin(), frameTimes.end()) << " ms, max "
+            << *std::max_element(frameTimes.begin(), frameTimes.end()) << " ms" << std::endl;
+    }
+
+private:
+    unsigned int FBO = 0, colorRBO = 0, depthRBO = 0;
+    int width = 0, height = 0;
+    std::chrono::steady_clock::time_point frameStart;
+    std::vector<double> cpuTimes;
+    std::vector<double> frameTimes;
+};
+
+#endif
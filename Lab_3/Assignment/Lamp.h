@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
 #include "Cube.h"
+#include "SceneNode.h"
 
 class Lamp {
 public:
@@ -48,45 +49,57 @@ public:
         shadeColor = shadeCol;
     }
 
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz,
+    // Build the lamp under parent; returns its ceiling mount node. The swing and
+    // shade pivots are kept so setPose() can animate them.
+    SceneNode* build(SceneNode* parent, float tx, float ty, float tz,
         float lampRotation = 0.0f, float swingAngle = 0.0f) {
 
         // Ceiling mount base - mounted at the ceiling position
-        glm::mat4 ceilingMount = glm::translate(parentModel, glm::vec3(tx, ty, tz));
+        SceneNode* ceilingMount = parent->addChild(glm::vec3(tx, ty, tz));
 
         // Mounting plate on ceiling
-        cube.draw(shader, ceilingMount, -mountingPlateSize / 2.0f, 0.0f, -mountingPlateSize / 2.0f,
+        ceilingMount->addPart(cube.getMesh(), -mountingPlateSize / 2.0f, 0.0f, -mountingPlateSize / 2.0f,
             0.0f, 0.0f, 0.0f,
             mountingPlateSize, 0.05f, mountingPlateSize, mountingColor);
 
         // Apply swing rotation at the mounting point
-        glm::mat4 swingBase = glm::rotate(ceilingMount, glm::radians(swingAngle), glm::vec3(1.0f, 0.0f, 0.0f));
+        swingNode = ceilingMount->addChild(glm::vec3(0.0f), glm::vec3(swingAngle, 0.0f, 0.0f));
 
         // Hanging rod (goes downward from ceiling)
-        cube.draw(shader, swingBase, -rodThickness / 2.0f, -rodLength, -rodThickness / 2.0f,
+        swingNode->addPart(cube.getMesh(), -rodThickness / 2.0f, -rodLength, -rodThickness / 2.0f,
             0.0f, 0.0f, 0.0f,
             rodThickness, rodLength, rodThickness, rodColor);
 
         // Lamp shade at the bottom of the rod
-        glm::mat4 shadeBase = glm::translate(swingBase, glm::vec3(0.0f, -rodLength, 0.0f));
-        shadeBase = glm::rotate(shadeBase, glm::radians(lampRotation), glm::vec3(0.0f, 1.0f, 0.0f));
-        
+        shadeNode = swingNode->addChild(glm::vec3(0.0f, -rodLength, 0.0f), glm::vec3(0.0f, lampRotation, 0.0f));
+
         // Outer shade (lampshade housing)
-        cube.draw(shader, shadeBase, -shadeWidth / 2.0f, -shadeHeight, -shadeDepth / 2.0f,
+        shadeNode->addPart(cube.getMesh(), -shadeWidth / 2.0f, -shadeHeight, -shadeDepth / 2.0f,
             0.0f, 0.0f, 0.0f,
             shadeWidth, shadeHeight, shadeDepth, shadeColor);
 
         // Light bulb inside the shade
         glm::vec3 bulbColor = glm::vec3(1.0f, 1.0f, 0.5f);
-        cube.draw(shader, shadeBase, -shadeWidth * 0.15f / 2.0f, -shadeHeight * 0.5f, -shadeDepth * 0.15f / 2.0f,
+        shadeNode->addPart(cube.getMesh(), -shadeWidth * 0.15f / 2.0f, -shadeHeight * 0.5f, -shadeDepth * 0.15f / 2.0f,
             0.0f, 0.0f, 0.0f,
             shadeWidth * 0.15f, shadeHeight * 0.4f, shadeDepth * 0.15f, bulbColor);
+
+        return ceilingMount;
     }
 
-    void draw(Shader& shader, glm::vec3 position, float lampRotation = 0.0f, float swingAngle = 0.0f) {
-        glm::mat4 identity = glm::mat4(1.0f);
-        draw(shader, identity, position.x, position.y, position.z, lampRotation, swingAngle);
+    // Animate the most recently built lamp; only the moving pivots become dirty
+    void setPose(float lampRotation, float swingAngle) {
+        swingNode->setRotation(glm::vec3(swingAngle, 0.0f, 0.0f));
+        shadeNode->setRotation(glm::vec3(0.0f, lampRotation, 0.0f));
     }
+
+    SceneNode* build(SceneNode* parent, glm::vec3 position, float lampRotation = 0.0f, float swingAngle = 0.0f) {
+        return build(parent, position.x, position.y, position.z, lampRotation, swingAngle);
+    }
+
+private:
+    SceneNode* swingNode = nullptr;
+    SceneNode* shadeNode = nullptr;
 };
 
 #endif
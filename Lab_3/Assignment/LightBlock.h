@@ -0,0 +1,84 @@
+#ifndef LIGHT_BLOCK_H
+#define LIGHT_BLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include "shader.h"
+
+// CPU mirrors of the light structs in fragmentShader.fs, laid out by std140 rules:
+// a vec3 is aligned to 16 bytes, a float may fill the 4 bytes after a vec3,
+// and every struct is padded to a multiple of 16 bytes.
+struct DirectionalLightStd140 {
+    glm::vec3 direction; float pad0;
+    glm::vec3 ambient;   float pad1;
+    glm::vec3 diffuse;   float pad2;
+    glm::vec3 specular;  float pad3;
+};
+
+struct SpotLightStd140 {
+    glm::vec3 position;  float pad0;
+    glm::vec3 direction;
+    float cutOff;
+    glm::vec3 ambient;   float pad1;
+    glm::vec3 diffuse;   float pad2;
+    glm::vec3 specular;
+    float k_c;
+    float k_l;
+    float k_q;
+    float pad3[2];
+};
+
+// Everything the lighting shader needs except viewPos, which changes per viewport.
+// Point lights are not stored here; they go through the buffer textures in ClusteredLights.h.
+// The light and component toggles are shader permutations, not block members.
+struct LightBlock {
+    DirectionalLightStd140 directionalLight;
+    SpotLightStd140 spotLight;
+    int numPointLights;
+    int pad[3];   // std140 rounds the block size up to 16 bytes
+};
+
+static_assert(sizeof(DirectionalLightStd140) == 64, "std140 DirectionalLight is 64 bytes");
+static_assert(sizeof(SpotLightStd140) == 96, "std140 SpotLight is 96 bytes");
+static_assert(offsetof(SpotLightStd140, cutOff) == 28, "cutOff packs after direction");
+static_assert(offsetof(LightBlock, spotLight) == 64, "spotLight follows directionalLight");
+static_assert(offsetof(LightBlock, numPointLights) == 64 + 96, "scalars follow spotLight");
+static_assert(sizeof(LightBlock) == 176, "std140 LightBlock is 176 bytes");
+
+// Owns the uniform buffer backing LightBlock
+class LightUniformBuffer {
+public:
+    static const unsigned int BINDING_POINT = 0;
+
+    LightUniformBuffer() {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlock), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, UBO);
+    }
+
+    ~LightUniformBuffer() {
+        glDeleteBuffers(1, &UBO);
+    }
+
+    // Point the shader's LightBlock at our binding point (once per program)
+    void bindTo(const Shader& shader) const {
+        unsigned int blockIndex = glGetUniformBlockIndex(shader.ID, "LightBlock");
+        if (blockIndex != GL_INVALID_INDEX)
+            glUniformBlockBinding(shader.ID, blockIndex, BINDING_POINT);
+    }
+
+    // One upload per frame, shared by every viewport
+    void upload(const LightBlock& block) const {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightBlock), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+private:
+    unsigned int UBO;
+};
+
+#endif
@@ -8,8 +8,24 @@
 #include "Boilerplate.h"
 #include "Lamp.h"
 #include "Window.h"
+#include "LightBlock.h"
+#include "ClusteredLights.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
+#include "Bvh.h"
+#include "ShaderPermutations.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
+#include "SoftwareRasterizer.h"
+#include "PhongShading.h"
 
 #include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
 
 using namespace std;
 
@@ -35,6 +51,41 @@ float lampSwingAngle = 0.0f;  // Key P to swing ceiling lamp
 // Rotation for LookAt (Key F)
 float orbitAngle = 1.0f;
 
+// Everything update() animates, saved before each simulation tick. render()
+// draws the state between that and the current one (see Application::run).
+struct AnimationState {
+    float fanAngle, doorAngle, lampRotation, lampSwingAngle;
+    glm::vec3 cameraPosition;
+    float cameraYaw, cameraPitch, cameraRoll;
+};
+AnimationState previousState;
+
+AnimationState currentAnimationState() {
+    return { fanAngle, doorAngle, lampRotation, lampSwingAngle,
+        camera.Position, camera.Yaw, camera.Pitch, camera.Roll };
+}
+
+// Blend angles in degrees the short way round, so 359 -> 1 does not spin back
+float lerpAngle(float from, float to, float t) {
+    float delta = to - from;
+    if (delta > 180.0f) delta -= 360.0f;
+    if (delta < -180.0f) delta += 360.0f;
+    return from + delta * t;
+}
+
+AnimationState interpolateState(const AnimationState& from, const AnimationState& to, float t) {
+    AnimationState state;
+    state.fanAngle = lerpAngle(from.fanAngle, to.fanAngle, t);
+    state.doorAngle = glm::mix(from.doorAngle, to.doorAngle, t);
+    state.lampRotation = lerpAngle(from.lampRotation, to.lampRotation, t);
+    state.lampSwingAngle = glm::mix(from.lampSwingAngle, to.lampSwingAngle, t);
+    state.cameraPosition = glm::mix(from.cameraPosition, to.cameraPosition, t);
+    state.cameraYaw = glm::mix(from.cameraYaw, to.cameraYaw, t);
+    state.cameraPitch = glm::mix(from.cameraPitch, to.cameraPitch, t);
+    state.cameraRoll = glm::mix(from.cameraRoll, to.cameraRoll, t);
+    return state;
+}
+
 // --- LIGHTING STATE VARIABLES ---
 bool directionalLightOn = true;   // Key 1
 bool pointLightOn = true;         // Key 2
@@ -42,9 +93,27 @@ bool spotLightOn = true;          // Key 3
 bool ambientOn = true;            // Key 5
 bool diffuseOn = true;            // Key 6
 bool specularOn = true;           // Key 7
+bool clusteredLighting = true;    // Key C
+bool frustumCulling = true;       // Key V
+bool perVertexNormalMatrix = false;   // --per-vertex-normals, the old vertex shader path
+
+// Lighting programs, one per combination of the toggles above (compiled on
+// first use); ourShader is the one matching the current toggles
+enum LightingFeature {
+    FEATURE_DIRECTIONAL_LIGHT = 1 << 0,
+    FEATURE_POINT_LIGHTS = 1 << 1,
+    FEATURE_SPOT_LIGHT = 1 << 2,
+    FEATURE_AMBIENT = 1 << 3,
+    FEATURE_DIFFUSE = 1 << 4,
+    FEATURE_SPECULAR = 1 << 5,
+    FEATURE_PER_VERTEX_NORMAL_MATRIX = 1 << 6   // benchmark only: invert the model matrix per vertex
+};
+ShaderPermutations* lightingShaders = nullptr;
 
 // Object instances
 Shader* ourShader = nullptr;
+int projectionLocation = -1;   // ourShader's camera matrices, resolved when it is selected
+int viewLocation = -1;
 Cube* cube = nullptr;
 Boundary* room = nullptr;
 Table* teacherTable = nullptr;
@@ -55,6 +124,59 @@ Monitor* monitor = nullptr;
 Lamp* ceilingLamp = nullptr;
 Window* classroomWindow = nullptr;
 
+// Scene graph built once in setup(); drawScene() only updates the animated nodes
+SceneNode* scene = nullptr;
+SceneNode* fanHub = nullptr;
+SceneNode* fanBlades = nullptr;
+SceneNode* doorPanel = nullptr;
+SceneNode* doorHandle = nullptr;
+
+// Frustum culling works on the top-level objects of the scene (a table, a chair,
+// a wall, the lamp...): drawScene() records each object's draws as one range
+// and its world bounds, and every viewport submits only the ranges it can see
+std::vector<DrawRange> objectDraws;
+BoundsSoA objectBounds;
+
+// The same object boxes in a BVH, refit as animated objects move. Culling walks
+// it once the scene is big enough that the linear test stops being cheaper;
+// picking (Key I) always uses it.
+Bvh sceneBvh;
+std::vector<Aabb> sceneBoxes;
+const size_t BVH_CULL_THRESHOLD = 256;
+
+struct CullStats {
+    size_t drawn = 0;
+    size_t culled = 0;
+};
+
+// One of the four views, with the ranges of the objects it can see
+struct ViewportView {
+    const char* name;
+    int x, y, width, height;
+    glm::vec3 eye;
+    glm::mat4 view;
+    glm::mat4 projection;
+    std::vector<DrawRange> draws;
+    CullStats stats;
+};
+
+// Everything render() needs for one frame. recordFrame() fills a packet from
+// the simulation state (on the update thread with --pipelined) and render()
+// reads only the packet, so the next frame can be recorded into the other one
+// while this one is drawn.
+struct FramePacket {
+    unsigned int lightingFeatures = 0;
+    bool clusteredLighting = true;
+    DrawList draws;
+    ViewportView viewports[4];   // isometric, top, front, inside
+    size_t matrixUpdates = 0;
+};
+FramePacket packets[2];
+
+// Extra desk and chair pairs outside the room (--desks N), to load the renderer
+int extraDesks = 0;
+size_t sceneNodeCount = 0;
+
 void printUsage() {
     cout << "=== CAMERA CONTROLS ===" << endl;
     cout << "W/S/A/D - Move camera" << endl;
@@ -79,12 +201,75 @@ void printUsage() {
     cout << "6 - Toggle Diffuse" << endl;
     cout << "7 - Toggle Specular" << endl;
     cout << endl;
+    cout << "=== RENDERER CONTROLS ===" << endl;
+    cout << "C - Toggle clustered / brute-force point lights" << endl;
+    cout << "V - Toggle frustum culling" << endl;
+    cout << "I - Identify the object in front of the camera and list objects nearby" << endl;
+    cout << endl;
     cout << "ESC - Exit" << endl;
 }
 
+// Lights live in a std140 uniform block shared by all four viewports
+LightBlock lightBlock;
+LightUniformBuffer* lightBuffer = nullptr;
+int viewPosLocation = -1;
+
+// Point lights are binned into clusters once per viewport
+std::vector<PointLightData> pointLights;
+LightClusterGrid* lightClusters = nullptr;
+int useClustersLocation = -1;
+LightClusterGrid::Uniforms clusterUniforms;
+
+void setDefaultPointLights();
+void buildScene();
+void setupScene();
+
+// Lighting program features for the current toggles
+unsigned int lightingFeatures() {
+    unsigned int features = 0;
+    if (directionalLightOn) features |= FEATURE_DIRECTIONAL_LIGHT;
+    if (pointLightOn) features |= FEATURE_POINT_LIGHTS;
+    if (spotLightOn) features |= FEATURE_SPOT_LIGHT;
+    if (ambientOn) features |= FEATURE_AMBIENT;
+    if (diffuseOn) features |= FEATURE_DIFFUSE;
+    if (specularOn) features |= FEATURE_SPECULAR;
+    if (perVertexNormalMatrix) features |= FEATURE_PER_VERTEX_NORMAL_MATRIX;
+    return features;
+}
+
+// Switch to the program for these features, compiling it on first use
+void selectLightingProgram(unsigned int features) {
+    Shader* program = &lightingShaders->get(features);
+    if (program == ourShader) return;
+    ourShader = program;
+    projectionLocation = ourShader->uniform("projection");
+    viewLocation = ourShader->uniform("view");
+    viewPosLocation = ourShader->uniform("viewPos");
+    useClustersLocation = ourShader->uniform("useClusters");
+    clusterUniforms = LightClusterGrid::Uniforms::locate(*ourShader);
+}
+
 void setup() {
     // Initialize shaders and objects
-    ourShader = new Shader("vertexShader.vs", "fragmentShader.fs");
+    lightBuffer = new LightUniformBuffer();
+    lightClusters = new LightClusterGrid();
+    lightingShaders = new ShaderPermutations("vertexShader.vs", "fragmentShader.fs",
+        { "DIRECTIONAL_LIGHT", "POINT_LIGHTS", "SPOT_LIGHT", "AMBIENT", "DIFFUSE", "SPECULAR", "PER_VERTEX_NORMAL_MATRIX" },
+        [](Shader& shader) {
+            lightBuffer->bindTo(shader);
+            shader.use();
+            lightClusters->bindTo(shader);
+        });
+    selectLightingProgram(lightingFeatures());
+    ProgramCache::printSummary();
+    setupScene();
+
+    printUsage();
+}
+
+// Lights and the scene graph; needs no GL context
+void setupScene() {
+    setDefaultPointLights();
     cube = new Cube();
     room = new Boundary();
     // Teacher's desk - rich dark mahogany wood
@@ -98,83 +283,88 @@ void setup() {
     monitor = new Monitor();
     ceilingLamp = new Lamp();
     classroomWindow = new Window();
-
-    printUsage();
+    buildScene();
+    sceneNodeCount = scene->nodeCount();
+    previousState = currentAnimationState();
 }
 
-// Function to set up all lighting uniforms
-void setupLighting(Shader& shader, glm::vec3 viewPos) {
-    shader.setVec3("viewPos", viewPos);
-
-    // Light toggles
-    shader.setBool("directionalLightOn", directionalLightOn);
-    shader.setBool("pointLightOn", pointLightOn);
-    shader.setBool("spotLightOn", spotLightOn);
+void addPointLight(glm::vec3 position, glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular,
+    float k_c, float k_l, float k_q) {
+    pointLights.push_back({ position, ambient, diffuse, specular, k_c, k_l, k_q });
+}
 
-    // Component toggles
-    shader.setBool("ambientOn", ambientOn);
-    shader.setBool("diffuseOn", diffuseOn);
-    shader.setBool("specularOn", specularOn);
-
-    // Directional Light (sunlight coming through window - from left side)
-    // Window is on left wall (x = -5), so light direction points into room (+X, slightly down)
-    shader.setVec3("directionalLight.direction", glm::vec3(1.0f, -0.3f, 0.2f));
-    shader.setVec3("directionalLight.ambient", glm::vec3(0.2f, 0.2f, 0.25f));
-    shader.setVec3("directionalLight.diffuse", glm::vec3(0.8f, 0.8f, 0.7f));
-    shader.setVec3("directionalLight.specular", glm::vec3(0.5f, 0.5f, 0.4f));
+// The four classroom lights
+void setDefaultPointLights() {
+    pointLights.clear();
 
     // Point Light 0 - Ceiling lamp position
-    shader.setVec3("pointLights[0].position", glm::vec3(1.5f, 3.2f, 1.0f));
-    shader.setVec3("pointLights[0].ambient", glm::vec3(0.1f, 0.1f, 0.08f));
-    shader.setVec3("pointLights[0].diffuse", glm::vec3(0.8f, 0.75f, 0.6f));
-    shader.setVec3("pointLights[0].specular", glm::vec3(0.5f, 0.5f, 0.4f));
-    shader.setFloat("pointLights[0].k_c", 1.0f);
-    shader.setFloat("pointLights[0].k_l", 0.09f);
-    shader.setFloat("pointLights[0].k_q", 0.032f);
+    addPointLight(glm::vec3(1.5f, 3.2f, 1.0f), glm::vec3(0.1f, 0.1f, 0.08f),
+        glm::vec3(0.8f, 0.75f, 0.6f), glm::vec3(0.5f, 0.5f, 0.4f), 1.0f, 0.09f, 0.032f);
 
     // Point Light 1 - Front left corner
-    shader.setVec3("pointLights[1].position", glm::vec3(-3.0f, 3.0f, -3.0f));
-    shader.setVec3("pointLights[1].ambient", glm::vec3(0.08f, 0.08f, 0.1f));
-    shader.setVec3("pointLights[1].diffuse", glm::vec3(0.5f, 0.5f, 0.6f));
-    shader.setVec3("pointLights[1].specular", glm::vec3(0.3f, 0.3f, 0.4f));
-    shader.setFloat("pointLights[1].k_c", 1.0f);
-    shader.setFloat("pointLights[1].k_l", 0.09f);
-    shader.setFloat("pointLights[1].k_q", 0.032f);
+    addPointLight(glm::vec3(-3.0f, 3.0f, -3.0f), glm::vec3(0.08f, 0.08f, 0.1f),
+        glm::vec3(0.5f, 0.5f, 0.6f), glm::vec3(0.3f, 0.3f, 0.4f), 1.0f, 0.09f, 0.032f);
 
     // Point Light 2 - Front right corner
-    shader.setVec3("pointLights[2].position", glm::vec3(3.0f, 3.0f, -3.0f));
-    shader.setVec3("pointLights[2].ambient", glm::vec3(0.08f, 0.08f, 0.1f));
-    shader.setVec3("pointLights[2].diffuse", glm::vec3(0.5f, 0.5f, 0.6f));
-    shader.setVec3("pointLights[2].specular", glm::vec3(0.3f, 0.3f, 0.4f));
-    shader.setFloat("pointLights[2].k_c", 1.0f);
-    shader.setFloat("pointLights[2].k_l", 0.09f);
-    shader.setFloat("pointLights[2].k_q", 0.032f);
+    addPointLight(glm::vec3(3.0f, 3.0f, -3.0f), glm::vec3(0.08f, 0.08f, 0.1f),
+        glm::vec3(0.5f, 0.5f, 0.6f), glm::vec3(0.3f, 0.3f, 0.4f), 1.0f, 0.09f, 0.032f);
 
     // Point Light 3 - Back center
-    shader.setVec3("pointLights[3].position", glm::vec3(0.0f, 3.0f, 3.0f));
-    shader.setVec3("pointLights[3].ambient", glm::vec3(0.08f, 0.08f, 0.1f));
-    shader.setVec3("pointLights[3].diffuse", glm::vec3(0.5f, 0.5f, 0.6f));
-    shader.setVec3("pointLights[3].specular", glm::vec3(0.3f, 0.3f, 0.4f));
-    shader.setFloat("pointLights[3].k_c", 1.0f);
-    shader.setFloat("pointLights[3].k_l", 0.09f);
-    shader.setFloat("pointLights[3].k_q", 0.032f);
+    addPointLight(glm::vec3(0.0f, 3.0f, 3.0f), glm::vec3(0.08f, 0.08f, 0.1f),
+        glm::vec3(0.5f, 0.5f, 0.6f), glm::vec3(0.3f, 0.3f, 0.4f), 1.0f, 0.09f, 0.032f);
+}
+
+// Fill the light block (CPU side only)
+void fillLightBlock() {
+    // Directional Light (sunlight coming through window - from left side)
+    // Window is on left wall (x = -5), so light direction points into room (+X, slightly down)
+    lightBlock.directionalLight.direction = glm::vec3(1.0f, -0.3f, 0.2f);
+    lightBlock.directionalLight.ambient = glm::vec3(0.2f, 0.2f, 0.25f);
+    lightBlock.directionalLight.diffuse = glm::vec3(0.8f, 0.8f, 0.7f);
+    lightBlock.directionalLight.specular = glm::vec3(0.5f, 0.5f, 0.4f);
+
+    // Point lights go through buffer textures, not the block
+    lightBlock.numPointLights = (int)pointLights.size();
 
     // Spot Light - Teacher's desk spotlight
-    shader.setVec3("spotLight.position", glm::vec3(0.0f, 3.5f, -3.5f));
-    shader.setVec3("spotLight.direction", glm::vec3(0.0f, -1.0f, -0.3f));
-    shader.setFloat("spotLight.cutOff", glm::cos(glm::radians(25.0f)));
-    shader.setVec3("spotLight.ambient", glm::vec3(0.05f, 0.05f, 0.05f));
-    shader.setVec3("spotLight.diffuse", glm::vec3(0.9f, 0.9f, 0.8f));
-    shader.setVec3("spotLight.specular", glm::vec3(0.7f, 0.7f, 0.6f));
-    shader.setFloat("spotLight.k_c", 1.0f);
-    shader.setFloat("spotLight.k_l", 0.07f);
-    shader.setFloat("spotLight.k_q", 0.017f);
+    lightBlock.spotLight.position = glm::vec3(0.0f, 3.5f, -3.5f);
+    lightBlock.spotLight.direction = glm::vec3(0.0f, -1.0f, -0.3f);
+    lightBlock.spotLight.cutOff = glm::cos(glm::radians(25.0f));
+    lightBlock.spotLight.ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+    lightBlock.spotLight.diffuse = glm::vec3(0.9f, 0.9f, 0.8f);
+    lightBlock.spotLight.specular = glm::vec3(0.7f, 0.7f, 0.6f);
+    lightBlock.spotLight.k_c = 1.0f;
+    lightBlock.spotLight.k_l = 0.07f;
+    lightBlock.spotLight.k_q = 0.017f;
+}
+
+// Fill the light block and upload it, with the point lights, once per frame
+void updateLightBlock(bool clustered) {
+    fillLightBlock();
+    lightClusters->uploadLights(pointLights);
+    lightBuffer->upload(lightBlock);
+    ourShader->setBool(useClustersLocation, clustered);
+}
+
+// Per-viewport lighting state; everything else comes from the light block
+void setupLighting(Shader& shader, glm::vec3 viewPos) {
+    PROFILE_ZONE("setupLighting");
+    shader.setVec3(viewPosLocation, viewPos);
+}
 
-    // Default: not emissive
-    shader.setBool("isEmissive", false);
+// Bin the point lights for one viewport (binning is skipped for the brute-force loop,
+// which still reads the light data texture)
+void setupLightClusters(Shader& shader, const glm::mat4& view, const glm::mat4& projection,
+    float zNear, float zFar, int x, int y, int width, int height, bool clustered) {
+    GPU_ZONE("light clusters");
+    if (clustered)
+        lightClusters->build(view, projection, zNear, zFar);
+    lightClusters->apply(shader, clusterUniforms, x, y, width, height);
 }
 
+// One fixed simulation tick; deltaTime is always 1 / tick rate
 void update(GLFWwindow* window, float deltaTime) {
+    previousState = currentAnimationState();
     processInput(window, deltaTime);
 
     // Fan rotation
@@ -188,19 +378,21 @@ void update(GLFWwindow* window, float deltaTime) {
     if (!doorOpen && doorAngle > 0.0f) doorAngle -= 100.0f * deltaTime;
 }
 
-// Helper function to draw the entire scene
-void drawScene(Shader& shader, glm::mat4 identity) {
+// Build the classroom scene graph once; only the animated pivots change afterwards
+void buildScene() {
+    scene = new SceneNode();
+
     // 1. ROOM (Floor and Walls)
-    room->drawRoom(shader, identity);
+    room->buildRoom(scene);
 
     // 2. WINDOW on Left Wall
-    classroomWindow->draw(shader, identity, -4.95f, 1.0f, 0.0f, 0.0f, 90.0f, 0.0f);
+    classroomWindow->build(scene, -4.95f, 1.0f, 0.0f, 0.0f, 90.0f, 0.0f);
 
     // 3. CLASSROOM SETUP
     // Teacher's desk at front
-    teacherTable->draw(shader, identity, -1.25f, 0.0f, -4.0f, 0.0f, 0.0f, 0.0f);
-    monitor->draw(shader, identity, 1.0f, 0.8f, -3.0f, 0.0f, 0.0f, 0.0f);
-    teacherChair->draw(shader, identity, 0.40f, 0.0f, -4.3f, 0.0f, 180.0f, 0.0f);
+    teacherTable->build(scene, -1.25f, 0.0f, -4.0f, 0.0f, 0.0f, 0.0f);
+    monitor->build(scene, 1.0f, 0.8f, -3.0f, 0.0f, 0.0f, 0.0f);
+    teacherChair->build(scene, 0.40f, 0.0f, -4.3f, 0.0f, 180.0f, 0.0f);
 
     // Student desks - Row 1
     float row1Z = -2.0f;
@@ -211,28 +403,30 @@ void drawScene(Shader& shader, glm::mat4 identity) {
     // Row 1 - 3 desks
     for (int i = 0; i < 3; i++) {
         float xPos = startX + i * spacing;
-        studentTable->draw(shader, identity, xPos, 0.0f, row1Z, 0.0f, 0.0f, 0.0f);
-        studentChair->draw(shader, identity, xPos + 0.35f, 0.0f, row1Z + 0.9f, 0.0f, 0.0f, 0.0f);
+        studentTable->build(scene, xPos, 0.0f, row1Z, 0.0f, 0.0f, 0.0f);
+        studentChair->build(scene, xPos + 0.35f, 0.0f, row1Z + 0.9f, 0.0f, 0.0f, 0.0f);
     }
 
     // Row 2 - 3 desks (behind row 1)
     for (int i = 0; i < 3; i++) {
         float xPos = startX + i * spacing;
-        studentTable->draw(shader, identity, xPos, 0.0f, row2Z, 0.0f, 0.0f, 0.0f);
-        studentChair->draw(shader, identity, xPos + 0.35f, 0.0f, row2Z + 0.9f, 0.0f, 0.0f, 0.0f);
+        studentTable->build(scene, xPos, 0.0f, row2Z, 0.0f, 0.0f, 0.0f);
+        studentChair->build(scene, xPos + 0.35f, 0.0f, row2Z + 0.9f, 0.0f, 0.0f, 0.0f);
     }
 
+    Mesh* cubeMesh = cube->getMesh();
+
     // 4. CEILING FAN
-    glm::mat4 fanBase = glm::translate(identity, glm::vec3(0.0f, 3.5f, 0.0f));
-    cube->draw(shader, fanBase, -0.1f, 0.0f, -0.1f, 0.0f, fanAngle, 0.0f, 0.2f, 0.5f, 0.2f, glm::vec3(0.15f, 0.15f, 0.18f));
+    SceneNode* fanBase = scene->addChild(glm::vec3(0.0f, 3.5f, 0.0f));
+    fanHub = fanBase->addPart(cubeMesh, -0.1f, 0.0f, -0.1f, 0.0f, fanAngle, 0.0f, 0.2f, 0.5f, 0.2f, glm::vec3(0.15f, 0.15f, 0.18f));
 
     // Blades (rotate around hub) - off-white wooden blades
     glm::vec3 bladeColor = glm::vec3(0.92f, 0.9f, 0.85f);
-    glm::mat4 bladeCenter = glm::rotate(fanBase, glm::radians(fanAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-    cube->draw(shader, bladeCenter, 0.0f, 0.0f, 0.1f, 0.0f, 0.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
-    cube->draw(shader, bladeCenter, 0.1f, 0.0f, 0.0f, 0.0f, 90.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
-    cube->draw(shader, bladeCenter, 0.0f, 0.0f, -0.1f, 0.0f, 180.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
-    cube->draw(shader, bladeCenter, -0.1f, 0.0f, 0.0f, 0.0f, 270.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
+    fanBlades = fanBase->addChild(glm::vec3(0.0f), glm::vec3(0.0f, fanAngle, 0.0f));
+    fanBlades->addPart(cubeMesh, 0.0f, 0.0f, 0.1f, 0.0f, 0.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
+    fanBlades->addPart(cubeMesh, 0.1f, 0.0f, 0.0f, 0.0f, 90.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
+    fanBlades->addPart(cubeMesh, 0.0f, 0.0f, -0.1f, 0.0f, 180.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
+    fanBlades->addPart(cubeMesh, -0.1f, 0.0f, 0.0f, 0.0f, 270.0f, 0.0f, 0.2f, 0.05f, 1.5f, bladeColor);
 
     // 5. DOOR (Animating with Frame and Handle)
     glm::vec3 doorFramePos = glm::vec3(2.5f, 0.0f, -5.0f);
@@ -241,116 +435,321 @@ void drawScene(Shader& shader, glm::mat4 identity) {
     glm::vec3 handleColor = glm::vec3(0.72f, 0.58f, 0.2f);  // Brass door handle
 
     // Door frame
-    cube->draw(shader, identity, doorFramePos.x - 0.1f, 2.5f, doorFramePos.z, 0.0f, 0.0f, 0.0f, 1.3f, 0.2f, 0.15f, frameColor);
-    cube->draw(shader, identity, doorFramePos.x - 0.1f, 0.0f, doorFramePos.z, 0.0f, 0.0f, 0.0f, 0.1f, 2.7f, 0.15f, frameColor);
-    cube->draw(shader, identity, doorFramePos.x + 1.1f, 0.0f, doorFramePos.z, 0.0f, 0.0f, 0.0f, 0.1f, 2.7f, 0.15f, frameColor);
+    scene->addPart(cubeMesh, doorFramePos.x - 0.1f, 2.5f, doorFramePos.z, 0.0f, 0.0f, 0.0f, 1.3f, 0.2f, 0.15f, frameColor);
+    scene->addPart(cubeMesh, doorFramePos.x - 0.1f, 0.0f, doorFramePos.z, 0.0f, 0.0f, 0.0f, 0.1f, 2.7f, 0.15f, frameColor);
+    scene->addPart(cubeMesh, doorFramePos.x + 1.1f, 0.0f, doorFramePos.z, 0.0f, 0.0f, 0.0f, 0.1f, 2.7f, 0.15f, frameColor);
 
     // Door
-    glm::mat4 doorHinge = glm::translate(identity, doorFramePos);
-    cube->draw(shader, doorHinge, 1.0f, 0.0f, 0.0f, 0.0f, -doorAngle, 0.0f, 1.0f, 2.5f, 0.1f, doorColor);
+    SceneNode* doorHinge = scene->addChild(doorFramePos);
+    doorPanel = doorHinge->addPart(cubeMesh, 1.0f, 0.0f, 0.0f, 0.0f, -doorAngle, 0.0f, 1.0f, 2.5f, 0.1f, doorColor);
 
     // Door handle
-    glm::mat4 handleTransform = glm::rotate(doorHinge, glm::radians(-doorAngle), glm::vec3(0.0f, 1.0f, 0.0f));
-    cube->draw(shader, handleTransform, 0.2f, 1.2f, 0.15f, 0.0f, 0.0f, 90.0f, 0.3f, 0.05f, 0.05f, handleColor);
+    doorHandle = doorHinge->addChild(glm::vec3(0.0f), glm::vec3(0.0f, -doorAngle, 0.0f));
+    doorHandle->addPart(cubeMesh, 0.2f, 1.2f, 0.15f, 0.0f, 0.0f, 90.0f, 0.3f, 0.05f, 0.05f, handleColor);
 
     // 6. CEILING LAMP
-    ceilingLamp->draw(shader, identity, 1.5f, 4.0f, 1.0f, lampRotation, lampSwingAngle);
+    ceilingLamp->build(scene, 1.5f, 4.0f, 1.0f, lampRotation, lampSwingAngle);
+
+    // 7. EXTRA DESKS behind the back wall, 50 to a row
+    for (int i = 0; i < extraDesks; i++) {
+        float xPos = -45.0f + (i % 50) * spacing;
+        float zPos = 7.0f + (i / 50) * 2.5f;
+        studentTable->build(scene, xPos, 0.0f, zPos, 0.0f, 0.0f, 0.0f);
+        studentChair->build(scene, xPos + 0.35f, 0.0f, zPos + 0.9f, 0.0f, 0.0f, 0.0f);
+    }
 }
 
-void render() {
-    ourShader->use();
+// Build the BVH on the first frame; afterwards refit the objects whose box changed
+void updateSceneBvh() {
+    PROFILE_ZONE("bvh refit");
+    const std::vector<SceneNode*>& objects = scene->getChildren();
+    if (sceneBoxes.size() != objects.size()) {
+        sceneBoxes.clear();
+        for (SceneNode* object : objects)
+            sceneBoxes.push_back(object->getBounds());
+        sceneBvh.build(sceneBoxes);
+        return;
+    }
+    for (size_t i = 0; i < objects.size(); i++) {
+        const Aabb& box = objects[i]->getBounds();
+        if (box.min != sceneBoxes[i].min || box.max != sceneBoxes[i].max) {
+            sceneBoxes[i] = box;
+            sceneBvh.update((int)i, box);
+        }
+    }
+}
+
+// Helper function to record the entire scene into the render queue, replacing
+// what the list being recorded held. Only the animated nodes are touched; their
+// subtrees are the only world matrices recomputed, every static part reuses
+// its cached matrix. Objects are recorded in parallel, each into its own slice
+// of the list, so the draw order does not depend on the thread count.
+void drawScene(const AnimationState& state) {
+    PROFILE_ZONE("record scene");
+    fanHub->setRotation(glm::vec3(0.0f, state.fanAngle, 0.0f));
+    fanBlades->setRotation(glm::vec3(0.0f, state.fanAngle, 0.0f));
+    doorPanel->setRotation(glm::vec3(0.0f, -state.doorAngle, 0.0f));
+    doorHandle->setRotation(glm::vec3(0.0f, -state.doorAngle, 0.0f));
+    ceilingLamp->setPose(state.lampRotation, state.lampSwingAngle);
+
+    // Each object's slice only moves when objects are added, so it is found once
+    const std::vector<SceneNode*>& objects = scene->getChildren();
+    if (objectDraws.size() != objects.size()) {
+        objectDraws.clear();
+        size_t first = 0;
+        for (SceneNode* object : objects) {
+            size_t count = 0;
+            object->visitDrawables([&count](SceneNode&) { count++; });
+            objectDraws.push_back({ first, count });
+            first += count;
+        }
+        objectBounds.resize(objects.size());
+    }
+
+    DrawList& draws = RenderQueue::get().recordingList();
+    draws.clear();
+    draws.resize(objectDraws.empty() ? 0 : objectDraws.back().first + objectDraws.back().count);
+
+    // The objects' parent, so no two threads update it at once
+    scene->getWorld();
+    JobSystem::get().parallelFor(0, objects.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            size_t next = objectDraws[i].first;
+            objects[i]->visitDrawables([&](SceneNode& node) {
+                Cube::record(draws, next++, node.mesh, node.getWorld(), node.color);
+            });
+            objectBounds.set(i, objects[i]->getBounds());
+        }
+    });
+    updateSceneBvh();
+}
+
+// Draw ranges of the objects whose bounds intersect the view frustum, with
+// neighbouring survivors merged so each run is still one multi-draw call
+void cullScene(const glm::mat4& viewProjection, CullStats& stats, std::vector<DrawRange>& ranges) {
+    PROFILE_ZONE("frustum cull");
+    thread_local std::vector<unsigned char> visible;
+
+    if (!frustumCulling) {
+        visible.assign(objectDraws.size(), 1);
+    }
+    else if (objectDraws.size() >= BVH_CULL_THRESHOLD) {
+        visible.assign(objectDraws.size(), 0);
+        sceneBvh.queryFrustum(Frustum(viewProjection), [](int object) { visible[object] = 1; });
+    }
+    else {
+        Frustum(viewProjection).cull(objectBounds, visible);
+    }
+
+    ranges.clear();
+    stats = CullStats();
+    for (size_t i = 0; i < objectDraws.size(); i++) {
+        if (!visible[i]) {
+            stats.culled++;
+            continue;
+        }
+        stats.drawn++;
+        const DrawRange& draws = objectDraws[i];
+        if (!ranges.empty() && ranges.back().first + ranges.back().count == draws.first)
+            ranges.back().count += draws.count;
+        else
+            ranges.push_back(draws);
+    }
+}
+
+void setViewport(ViewportView& viewport, const char* name, int x, int y, int width, int height,
+    glm::vec3 eye, const glm::mat4& view, const glm::mat4& projection) {
+    viewport.name = name;
+    viewport.x = x;
+    viewport.y = y;
+    viewport.width = width;
+    viewport.height = height;
+    viewport.eye = eye;
+    viewport.view = view;
+    viewport.projection = projection;
+}
+
+// Record the scene once and cull it for every viewport. 'alpha' blends from
+// the state before the last tick (0) to the current one (1).
+void recordFrame(FramePacket& packet, float alpha) {
+    PROFILE_ZONE("record frame");
+    packet.lightingFeatures = lightingFeatures();
+    packet.clusteredLighting = clusteredLighting;
+
+    RenderQueue::get().recordInto(packet.draws);
+    SceneNode::matrixUpdates = 0;
+    AnimationState shown = interpolateState(previousState, currentAnimationState(), alpha);
+    drawScene(shown);
+    packet.matrixUpdates = SceneNode::matrixUpdates;
 
-    glm::mat4 identity = glm::mat4(1.0f);
-    
     // Viewport dimensions (half width, half height)
     int halfW = SCR_WIDTH / 2;
     int halfH = SCR_HEIGHT / 2;
     float aspect = (float)halfW / (float)halfH;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+    // TOP-LEFT VIEWPORT: Isometric View (elevated corner view)
+    glm::vec3 isoPos = glm::vec3(12.0f, 10.0f, 12.0f);
+    setViewport(packet.viewports[0], "isometric viewport", 0, halfH, halfW, halfH, isoPos,
+        glm::lookAt(isoPos, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)), projection);
 
-    // ============================================
-    // TOP-LEFT VIEWPORT: Isometric View
-    // ============================================
-    glViewport(0, halfH, halfW, halfH);
-    glScissor(0, halfH, halfW, halfH);
-    glEnable(GL_SCISSOR_TEST);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    
-    {
-        // Isometric camera position (elevated corner view)
-        glm::vec3 isoPos = glm::vec3(12.0f, 10.0f, 12.0f);
-        glm::vec3 isoTarget = glm::vec3(0.0f, 1.0f, 0.0f);
-        glm::mat4 isoView = glm::lookAt(isoPos, isoTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-        glm::mat4 isoProj = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
-        
-        ourShader->setMat4("projection", isoProj);
-        ourShader->setMat4("view", isoView);
-        setupLighting(*ourShader, isoPos);
-        drawScene(*ourShader, identity);
-    }
-
-    // ============================================
     // TOP-RIGHT VIEWPORT: Top View (Bird's Eye)
-    // ============================================
-    glViewport(halfW, halfH, halfW, halfH);
-    glScissor(halfW, halfH, halfW, halfH);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    
-    {
-        // Top-down view
-        glm::vec3 topPos = glm::vec3(0.0f, 15.0f, 0.01f);
-        glm::vec3 topTarget = glm::vec3(0.0f, 0.0f, 0.0f);
-        glm::mat4 topView = glm::lookAt(topPos, topTarget, glm::vec3(0.0f, 0.0f, -1.0f));
-        glm::mat4 topProj = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
-        
-        ourShader->setMat4("projection", topProj);
-        ourShader->setMat4("view", topView);
-        setupLighting(*ourShader, topPos);
-        drawScene(*ourShader, identity);
-    }
-
-    // ============================================
-    // BOTTOM-LEFT VIEWPORT: Front View
-    // ============================================
-    glViewport(0, 0, halfW, halfH);
-    glScissor(0, 0, halfW, halfH);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    
-    {
-        // Front view (looking at the front wall/teacher's desk)
-        glm::vec3 frontPos = glm::vec3(0.0f, 2.0f, 10.0f);
-        glm::vec3 frontTarget = glm::vec3(0.0f, 1.5f, -5.0f);
-        glm::mat4 frontView = glm::lookAt(frontPos, frontTarget, glm::vec3(0.0f, 1.0f, 0.0f));
-        glm::mat4 frontProj = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
-        
-        ourShader->setMat4("projection", frontProj);
-        ourShader->setMat4("view", frontView);
-        setupLighting(*ourShader, frontPos);
-        drawScene(*ourShader, identity);
-    }
-
-    // ============================================
+    glm::vec3 topPos = glm::vec3(0.0f, 15.0f, 0.01f);
+    setViewport(packet.viewports[1], "top viewport", halfW, halfH, halfW, halfH, topPos,
+        glm::lookAt(topPos, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f)), projection);
+
+    // BOTTOM-LEFT VIEWPORT: Front View (looking at the front wall/teacher's desk)
+    glm::vec3 frontPos = glm::vec3(0.0f, 2.0f, 10.0f);
+    setViewport(packet.viewports[2], "front viewport", 0, 0, halfW, halfH, frontPos,
+        glm::lookAt(frontPos, glm::vec3(0.0f, 1.5f, -5.0f), glm::vec3(0.0f, 1.0f, 0.0f)), projection);
+
     // BOTTOM-RIGHT VIEWPORT: Inside View (User Camera)
-    // ============================================
-    glViewport(halfW, 0, halfW, halfH);
-    glScissor(halfW, 0, halfW, halfH);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    
+    BasicCamera shownCamera = camera;
+    shownCamera.Position = shown.cameraPosition;
+    shownCamera.Yaw = shown.cameraYaw;
+    shownCamera.Pitch = shown.cameraPitch;
+    shownCamera.Roll = shown.cameraRoll;
+    shownCamera.updateCameraVectors();
+    setViewport(packet.viewports[3], "inside viewport", halfW, 0, halfW, halfH, shownCamera.Position,
+        shownCamera.GetViewMatrix(), glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f));
+
+    // The viewports only read the scene, so they are culled side by side
+    JobSystem::get().parallelFor(0, 4, 1, [&packet](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            ViewportView& viewport = packet.viewports[i];
+            cullScene(viewport.projection * viewport.view, viewport.stats, viewport.draws);
+        }
+    });
+}
+
+// Draw a recorded frame; touches no simulation state
+void render(const FramePacket& packet) {
+    selectLightingProgram(packet.lightingFeatures);
+    ourShader->use();
+    updateLightBlock(packet.clusteredLighting);
+
+    // Every mesh lives in the arena, so its VAO is the only one bound this frame
+    MeshArena::get().bind();
+
+    // The scene was recorded once; every viewport submits the part of it it can see
+    RenderQueue& queue = RenderQueue::get();
+    queue.glDrawCalls = 0;
     {
-        // User-controlled camera (inside view)
-        glm::mat4 insideView = camera.GetViewMatrix();
-        glm::mat4 insideProj = glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f);
-        
-        ourShader->setMat4("projection", insideProj);
-        ourShader->setMat4("view", insideView);
-        setupLighting(*ourShader, camera.Position);
-        drawScene(*ourShader, identity);
+        GPU_ZONE("upload draws");
+        queue.upload(packet.draws);
     }
 
+    glEnable(GL_SCISSOR_TEST);
+    for (const ViewportView& viewport : packet.viewports) {
+        glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+        glScissor(viewport.x, viewport.y, viewport.width, viewport.height);
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        GPU_ZONE(viewport.name);
+        ourShader->setMat4(projectionLocation, viewport.projection);
+        ourShader->setMat4(viewLocation, viewport.view);
+        setupLighting(*ourShader, viewport.eye);
+        setupLightClusters(*ourShader, viewport.view, viewport.projection, 0.1f, 100.0f,
+            viewport.x, viewport.y, viewport.width, viewport.height, packet.clusteredLighting);
+        queue.submit(viewport.draws);
+    }
     glDisable(GL_SCISSOR_TEST);
+
+    // Report draw call counts once, and the world matrices the scene graph
+    // computed on the first frame (all of them) and the second (only what moved)
+    static int framesReported = 0;
+    if (framesReported == 0) {
+        cout << endl << "Scene: " << packet.draws.size() << " draws recorded, "
+            << packet.draws.size() * 4 << " glDrawElements calls per frame without batching, "
+            << queue.glDrawCalls << " with " << (queue.useMultiDraw() ? "multi-draw indirect" : "the GL 3.3 fallback loop")
+            << endl;
+        cout << "Scene graph: " << sceneNodeCount << " nodes, "
+            << packet.matrixUpdates << " world matrices computed on the first frame" << endl;
+        const char* viewportNames[4] = { "isometric", "top", "front", "inside" };
+        cout << "Frustum culling (objects drawn/culled):";
+        for (int i = 0; i < 4; i++)
+            cout << " " << viewportNames[i] << " " << packet.viewports[i].stats.drawn << "/" << packet.viewports[i].stats.culled;
+        cout << endl;
+    }
+    else if (framesReported == 1) {
+        cout << "Scene graph: " << packet.matrixUpdates << " world matrices recomputed on the next frame" << endl;
+    }
+    if (framesReported < 2) framesReported++;
+}
+
+// Draw a recorded frame on the CPU (--software): the same draws, culled ranges
+// and viewports as render(), shaded by PhongShading instead of fragmentShader.fs
+void renderSoftware(SoftwareRasterizer& raster, const FramePacket& packet) {
+    PROFILE_ZONE("software render");
+    fillLightBlock();
+
+    PhongShading phong;
+    phong.directionalLight = (packet.lightingFeatures & FEATURE_DIRECTIONAL_LIGHT) != 0;
+    phong.pointLights = (packet.lightingFeatures & FEATURE_POINT_LIGHTS) != 0;
+    phong.spotLight = (packet.lightingFeatures & FEATURE_SPOT_LIGHT) != 0;
+    phong.ambient = (packet.lightingFeatures & FEATURE_AMBIENT) != 0;
+    phong.diffuse = (packet.lightingFeatures & FEATURE_DIFFUSE) != 0;
+    phong.specular = (packet.lightingFeatures & FEATURE_SPECULAR) != 0;
+    phong.lights = &lightBlock;
+    phong.pointLightData = &pointLights;
+
+    raster.setViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+    raster.clear(glm::vec3(0.1f));
+    raster.setVaryingCount(6);   // FragPos, Normal
+
+    const MeshArena& arena = MeshArena::get();
+    const float* vertices = arena.vertexData().data();
+    const unsigned int* indices = arena.indexData().data();
+    const DrawList& list = packet.draws;
+    vector<uint32_t> visible;
+
+    for (const ViewportView& viewport : packet.viewports) {
+        raster.setViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+        raster.clearDepth();
+        phong.viewPos = viewport.eye;
+
+        visible.clear();
+        for (const DrawRange& range : viewport.draws)
+            for (size_t i = range.first; i < range.first + range.count; i++) visible.push_back((uint32_t)i);
+
+        // vertexShader.vs per vertex, fragmentShader.fs per fragment
+        glm::mat4 viewProjection = viewport.projection * viewport.view;
+        raster.draw(visible.size(),
+            [&](size_t i, SoftwareRasterizer::Batch& batch) {
+                uint32_t draw = visible[i];
+                const DrawElementsIndirectCommand& command = list.commands[draw];
+                const DrawData& data = list.drawData[draw];
+                glm::mat3 normalMatrix(glm::vec3(data.normalMatrix[0]), glm::vec3(data.normalMatrix[1]), glm::vec3(data.normalMatrix[2]));
+                batch.indexed(vertices, 6, indices, command.firstIndex, command.count, command.baseVertex, draw,
+                    [&](const float* in, SoftwareRasterizer::Vertex& out) {
+                        glm::vec4 world = data.model * glm::vec4(in[0], in[1], in[2], 1.0f);
+                        glm::vec3 normal = normalMatrix * glm::vec3(in[3], in[4], in[5]);
+                        out.position = viewProjection * world;
+                        out.varyings[0] = world.x;
+                        out.varyings[1] = world.y;
+                        out.varyings[2] = world.z;
+                        out.varyings[3] = normal.x;
+                        out.varyings[4] = normal.y;
+                        out.varyings[5] = normal.z;
+                    });
+            },
+            [&](uint32_t draw, const float* varyings) {
+                const DrawData& data = list.drawData[draw];
+                PhongShading::Material material = { glm::vec3(data.ambient), glm::vec3(data.diffuse),
+                    glm::vec3(data.specular), data.specular.w };
+                return phong.shade(material, glm::vec3(varyings[0], varyings[1], varyings[2]),
+                    glm::vec3(varyings[3], varyings[4], varyings[5]));
+            });
+    }
 }
 
 void cleanup() {
-    delete ourShader;
+    delete lightingShaders;
+    ourShader = nullptr;
+    delete lightBuffer;
+    delete lightClusters;
+    RenderQueue::get().reset();
+    delete scene;
     delete cube;
     delete room;
     delete teacherTable;
@@ -362,88 +761,521 @@ void cleanup() {
     delete classroomWindow;
 }
 
-int main() {
+// Scatter 'count' small colored lights (about 1.2 m reach) through the room
+void setBenchmarkPointLights(int count) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> x(-4.5f, 4.5f), y(0.2f, 3.8f), z(-4.5f, 4.5f), c(0.2f, 1.0f);
+
+    pointLights.clear();
+    for (int i = 0; i < count; i++) {
+        glm::vec3 color(c(rng), c(rng), c(rng));
+        addPointLight(glm::vec3(x(rng), y(rng), z(rng)), glm::vec3(0.0f), color * 0.25f, color * 0.1f,
+            1.0f, 3.0f, 60.0f);
+    }
+}
+
+// Average frame time in ms over 'frames' frames (after a short warm-up)
+double timeFrames(int frames) {
+    for (int i = 0; i < 3; i++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        recordFrame(packets[0], 1.0f);
+        render(packets[0]);
+    }
+    glFinish();
+
+    double start = glfwGetTime();
+    for (int i = 0; i < frames; i++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        recordFrame(packets[0], 1.0f);
+        render(packets[0]);
+        glFinish();
+    }
+    return (glfwGetTime() - start) * 1000.0 / frames;
+}
+
+// --light-benchmark [frames]: sweep 4..1024 point lights, brute force vs clustered
+void runLightBenchmark(int frames) {
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+
+    cout << endl << "=== POINT LIGHT BENCHMARK (" << frames << " frames per run, 4 viewports) ===" << endl;
+    cout << setw(8) << "lights" << setw(14) << "brute (ms)" << setw(16) << "clustered (ms)"
+        << setw(10) << "speedup" << setw(18) << "max per cluster" << endl;
+
+    for (int count = 4; count <= 1024; count *= 2) {
+        setBenchmarkPointLights(count);
+
+        clusteredLighting = false;
+        double bruteMs = timeFrames(frames);
+
+        clusteredLighting = true;
+        double clusteredMs = timeFrames(frames);
+
+        cout << fixed << setprecision(2)
+            << setw(8) << count
+            << setw(14) << bruteMs
+            << setw(16) << clusteredMs
+            << setw(9) << bruteMs / clusteredMs << "x"
+            << setw(18) << lightClusters->lastMaxLightsPerCluster() << endl;
+    }
+
+    setDefaultPointLights();
+}
+
+// --job-benchmark [frames]: record and cull the scene (by default with 5000
+// extra desks) on 1, 2, 4... threads, up to twice the core count
+void runJobBenchmark(int frames) {
+    JobSystem& jobs = JobSystem::get();
+    int cores = (int)max(1u, thread::hardware_concurrency());
+    int restoreWorkers = jobs.workerCount();
+
+    cout << endl << "=== JOB SYSTEM BENCHMARK (" << scene->getChildren().size() << " objects, "
+        << frames << " frames per run, " << cores << " hardware threads) ===" << endl;
+    cout << setw(8) << "threads" << setw(14) << "record (ms)" << setw(10) << "speedup" << endl;
+
+    double oneThreadMs = 0.0;
+    for (int threads = 1; threads <= max(2 * cores, 4); threads *= 2) {
+        jobs.setWorkerCount(threads - 1);
+        for (int i = 0; i < 3; i++) recordFrame(packets[0], 1.0f);
+
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            // Keep the fan turning so its subtree is recomputed like in a real frame
+            fanAngle += 1.0f;
+            recordFrame(packets[0], 1.0f);
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / frames;
+        if (threads == 1) oneThreadMs = ms;
+
+        cout << fixed << setprecision(2)
+            << setw(8) << threads
+            << setw(14) << ms
+            << setw(9) << oneThreadMs / ms << "x"
+            << (threads > cores ? "  (more threads than cores)" : "") << endl;
+    }
+
+    jobs.setWorkerCount(restoreWorkers);
+}
+
+// --normal-benchmark [frames]: every object in all four viewports (culling off,
+// by default with 5000 extra desks), with the normal matrix inverted per vertex
+// in the shader vs computed per draw on the CPU
+void runNormalBenchmark(int frames) {
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    frustumCulling = false;
+
+    recordFrame(packets[0], 1.0f);
+    const DrawList& draws = packets[0].draws;
+    size_t fastPath = 0;
+    glm::vec4 normalMatrix[3];
+    for (const DrawData& data : draws.drawData)
+        if (computeNormalMatrix(data.model, normalMatrix)) fastPath++;
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) recordFrame(packets[0], 1.0f);
+    double recordMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / frames;
+
+    cout << endl << "=== NORMAL MATRIX BENCHMARK (" << draws.size() << " draws, 4 viewports, "
+        << frames << " frames per run) ===" << endl;
+    cout << fastPath << " of " << draws.size() << " draws have orthogonal axes (no inverse needed)" << endl;
+
+    // Whole frames, then the vertex stage alone (primitives discarded before rasterization)
+    cout << setw(32) << "" << setw(14) << "frame (ms)" << setw(20) << "vertex stage (ms)" << endl;
+    double frameMs[2], vertexMs[2];
+    for (int perDraw = 0; perDraw < 2; perDraw++) {
+        perVertexNormalMatrix = !perDraw;
+        frameMs[perDraw] = timeFrames(frames);
+        glEnable(GL_RASTERIZER_DISCARD);
+        vertexMs[perDraw] = timeFrames(frames);
+        glDisable(GL_RASTERIZER_DISCARD);
+        cout << fixed << setprecision(2)
+            << setw(32) << (perDraw ? "normal matrix per draw (CPU)" : "inverse per vertex (shader)")
+            << setw(14) << frameMs[perDraw] << setw(20) << vertexMs[perDraw] << endl;
+    }
+    perVertexNormalMatrix = false;
+
+    cout << fixed << setprecision(1)
+        << "Per-draw normal matrices: frame " << (1.0 - frameMs[1] / frameMs[0]) * 100.0 << "% faster, vertex stage "
+        << (1.0 - vertexMs[1] / vertexMs[0]) * 100.0 << "% faster; recording with them takes "
+        << setprecision(2) << recordMs << " ms on the CPU" << endl;
+
+    frustumCulling = true;
+}
+
+// Milliseconds spent in body(), best of 'runs'
+template <typename Body>
+double timeBest(int runs, Body&& body) {
+    double best = 1e30;
+    for (int run = 0; run < runs; run++) {
+        auto start = chrono::steady_clock::now();
+        body();
+        best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// --vertex-report: vertex memory of the scene's meshes as floats and packed,
+// and the worst error of the packed copy. False if a position is off by more
+// than a 16-bit step or a normal by more than MAX_NORMAL_ERROR_DEGREES.
+bool runVertexReport() {
+    setupScene();
+    const MeshArena& arena = MeshArena::get();
+    const VertexCompression::Error& error = arena.compressionError();
+    cout << arena.vertexCount() << " vertices: " << arena.floatVertexBytes() << " bytes as floats, "
+        << arena.packedVertexBytes() << " bytes packed (" << fixed << setprecision(1)
+        << 100.0 * arena.packedVertexBytes() / arena.floatVertexBytes() << "%)" << endl;
+    cout << setprecision(7) << "max position error " << error.position << " units, "
+        << setprecision(3) << error.steps << " steps; max normal error " << error.normalDegrees << " degrees" << endl;
+    bool passed = error.acceptable();
+    cout << (passed ? "Vertex compression within tolerance" : "Vertex compression error too large") << endl;
+    return passed;
+}
+
+// --bvh-benchmark: a grid of desk and chair boxes at 10K and 1M objects. Times
+// the SAH build, a full refit, refitting 1% of the objects one by one, frustum
+// culling (BVH vs the linear SSE test), and batches of ray and proximity queries.
+void runBvhBenchmark() {
+    cout << endl << "=== BVH BENCHMARK ===" << endl;
+    for (size_t count : { (size_t)10000, (size_t)1000000 }) {
+        // Rows of desk + chair pairs, like the classroom but much bigger
+        vector<Aabb> boxes;
+        int columns = (int)sqrt((double)count / 2.0);
+        for (size_t i = 0; boxes.size() < count; i++) {
+            glm::vec3 origin((float)(i % columns) * 1.8f, 0.0f, (float)(i / columns) * 2.5f);
+            Aabb desk, chair;
+            desk.add(origin);
+            desk.add(origin + glm::vec3(1.2f, 0.8f, 0.6f));
+            chair.add(origin + glm::vec3(0.35f, 0.0f, 0.9f));
+            chair.add(origin + glm::vec3(0.85f, 1.0f, 1.4f));
+            boxes.push_back(desk);
+            if (boxes.size() < count) boxes.push_back(chair);
+        }
+
+        BoundsSoA soa;
+        for (const Aabb& box : boxes) soa.push_back(box);
+
+        Bvh bvh;
+        double buildMs = timeBest(3, [&]() { bvh.build(boxes); });
+        double refitMs = timeBest(3, [&]() { bvh.refit(); });
+
+        // Nudge every hundredth object, as animated objects would
+        size_t moved = count / 100;
+        double updateMs = timeBest(3, [&]() {
+            for (size_t i = 0; i < count; i += 100) {
+                Aabb box = boxes[i];
+                box.min.y += 0.01f;
+                box.max.y += 0.01f;
+                bvh.update((int)i, box);
+            }
+        });
+
+        // A camera standing in the grid looking along a row
+        glm::vec3 eye((float)columns * 0.9f, 1.5f, -2.0f);
+        glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f)
+            * glm::lookAt(eye, eye + glm::vec3(0.3f, -0.1f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        Frustum frustum(viewProjection);
+
+        size_t bvhVisible = 0, linearVisible = 0;
+        vector<unsigned char> visible;
+        double bvhCullMs = timeBest(5, [&]() {
+            bvhVisible = 0;
+            bvh.queryFrustum(frustum, [&](int) { bvhVisible++; });
+        });
+        double linearCullMs = timeBest(5, [&]() { linearVisible = frustum.cull(soa, visible); });
+
+        // Picking rays from eye height down to a floor point up to 8 m away
+        const int queries = 10000;
+        mt19937 rng(7);
+        uniform_real_distribution<float> across(0.0f, columns * 1.8f), along(0.0f, (float)(count / columns) * 1.25f);
+        uniform_real_distribution<float> offset(-8.0f, 8.0f);
+        vector<glm::vec3> origins(queries), targets(queries);
+        for (int i = 0; i < queries; i++) {
+            origins[i] = glm::vec3(across(rng), 1.7f, along(rng));
+            targets[i] = origins[i] + glm::vec3(offset(rng), -1.7f, offset(rng));
+        }
+        int hits = 0;
+        double rayMs = timeBest(3, [&]() {
+            hits = 0;
+            for (int i = 0; i < queries; i++) {
+                float distance;
+                if (bvh.raycast(origins[i], glm::normalize(targets[i] - origins[i]), distance) >= 0) hits++;
+            }
+        });
+        size_t neighbours = 0;
+        double sphereMs = timeBest(3, [&]() {
+            neighbours = 0;
+            for (int i = 0; i < queries; i++)
+                bvh.querySphere(targets[i], 2.0f, [&](int) { neighbours++; });
+        });
+
+        cout << fixed << setprecision(3)
+            << count << " objects: " << bvh.getNodes().size() << " nodes, depth " << bvh.depth() << endl
+            << "  build " << buildMs << " ms, full refit " << refitMs << " ms, "
+            << moved << " single-object updates " << updateMs << " ms" << endl
+            << "  frustum cull: BVH " << bvhCullMs << " ms vs linear SSE " << linearCullMs << " ms ("
+            << bvhVisible << " / " << linearVisible << " visible)" << endl
+            << "  " << queries << " raycasts " << rayMs << " ms (" << hits << " hits), "
+            << queries << " 2 m proximity queries " << sphereMs << " ms ("
+            << (double)neighbours / queries << " objects each)" << endl;
+    }
+}
+
+// --software [frames]: render on the CPU without a GL context and write the
+// last frame to the --frame-out path
+void runSoftware(int frames, const string& imagePath) {
+    setupScene();
+    SoftwareRasterizer raster;
+    raster.resize(SCR_WIDTH, SCR_HEIGHT);
+
+    vector<double> frameTimes;
+    for (int i = 0; i < frames; i++) {
+        auto start = chrono::steady_clock::now();
+        recordFrame(packets[0], 1.0f);
+        raster.resetStats();
+        renderSoftware(raster, packets[0]);
+        frameTimes.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+
+    double total = 0.0;
+    for (double t : frameTimes) total += t;
+    const SoftwareRasterizer::Stats& stats = raster.stats();
+    cout << endl << "Software renderer: " << frames << " frames at " << SCR_WIDTH << "x" << SCR_HEIGHT << " on "
+        << JobSystem::get().workerCount() + 1 << " threads, frame time avg " << fixed << setprecision(2)
+        << total / frames << " ms, min " << *min_element(frameTimes.begin(), frameTimes.end()) << " ms" << endl;
+    cout << "Last frame: " << stats.triangles << " triangles (" << stats.clipped << " clipped), "
+        << stats.setUp << " rasterized in " << stats.binEntries << " tile bins, "
+        << stats.blocksSkipped << " blocks skipped by hierarchical Z, " << stats.fragments << " fragments shaded" << endl;
+    if (!raster.writeImage(imagePath))
+        cout << "Failed to write " << imagePath << endl;
+
+    cleanup();
+}
+
+void writeTrace(const char* path) {
+    if (!path) return;
+    if (Profiler::get().writeChromeTrace(path))
+        cout << "Trace written to " << path << " (open in chrome://tracing or ui.perfetto.dev)" << endl;
+    else
+        cout << "Failed to write " << path << endl;
+}
+
+int main(int argc, char** argv) {
+    // The spatial index benchmark and the vertex report need no window
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bvh-benchmark") == 0) {
+            runBvhBenchmark();
+            return 0;
+        }
+        if (strcmp(argv[i], "--vertex-report") == 0) {
+            return runVertexReport() ? 0 : 1;
+        }
+    }
+
     Application app(SCR_WIDTH, SCR_HEIGHT, "Assignment: 3D Lab");
+    HeadlessOptions headless = HeadlessOptions::parse(argc, argv);
+
+    // Command line options
+    int softwareFrames = 0;
+    int benchmarkFrames = 0;
+    int jobBenchmarkFrames = 0;
+    int normalBenchmarkFrames = 0;
+    bool pipelined = false;
+    const char* tracePath = nullptr;
+    const char* gpuLogPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--light-benchmark") == 0) {
+            benchmarkFrames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (benchmarkFrames > 0) i++;
+            else benchmarkFrames = 30;
+        }
+        else if (strcmp(argv[i], "--job-benchmark") == 0) {
+            jobBenchmarkFrames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (jobBenchmarkFrames > 0) i++;
+            else jobBenchmarkFrames = 30;
+        }
+        else if (strcmp(argv[i], "--normal-benchmark") == 0) {
+            normalBenchmarkFrames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (normalBenchmarkFrames > 0) i++;
+            else normalBenchmarkFrames = 10;
+        }
+        else if (strcmp(argv[i], "--per-vertex-normals") == 0) {
+            // Invert the model matrix per vertex in the shader, as before
+            perVertexNormalMatrix = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            // Threads for per-frame CPU work, including the one submitting it (default: one per core)
+            JobSystem::get().setWorkerCount(max(1, atoi(argv[++i])) - 1);
+        }
+        else if (strcmp(argv[i], "--no-multidraw") == 0) {
+            RenderQueue::get().multiDraw = false;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            // Record profiler zones and save them as a Chrome trace on exit
+            tracePath = argv[++i];
+            Profiler::setEnabled(true);
+            Profiler::get().setThreadName("main");
+        }
+        else if (strcmp(argv[i], "--gpu-timers") == 0) {
+            // Time each viewport and upload on the GPU; bars in the corner, times in the title
+            GpuTimer::setEnabled(true);
+        }
+        else if (strcmp(argv[i], "--gpu-log") == 0 && i + 1 < argc) {
+            // Log every resolved pass as CSV (implies --gpu-timers)
+            gpuLogPath = argv[++i];
+            GpuTimer::setEnabled(true);
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            // Simulation ticks per second (default 60), independent of the frame rate
+            app.setTickRate(atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--no-shader-cache") == 0) {
+            // Always compile shaders from source instead of using shader_cache/
+            ProgramCache::enabled() = false;
+        }
+        else if (strcmp(argv[i], "--pipelined") == 0) {
+            // Simulate and record the next frame on a second thread while this one is drawn
+            pipelined = true;
+        }
+        else if (strcmp(argv[i], "--desks") == 0 && i + 1 < argc) {
+            // Add N desk and chair pairs behind the classroom
+            extraDesks = max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--software") == 0) {
+            // Rasterize on the CPU, without a window or GL context
+            softwareFrames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (softwareFrames > 0) i++;
+            else softwareFrames = 1;
+        }
+    }
+
+    if (softwareFrames > 0) {
+        runSoftware(softwareFrames, headless.imagePath);
+        writeTrace(tracePath);
+        return 0;
+    }
 
-    if (!app.initialize()) {
+    // --headless [frames] renders offscreen and writes timings and the last frame
+    if (!app.initialize(headless)) {
         return -1;
     }
 
     GLFWwindow* window = app.getWindow();
+    if (gpuLogPath && !GpuTimer::get().openLog(gpuLogPath)) {
+        cout << "Failed to open " << gpuLogPath << endl;
+    }
+
+    if (benchmarkFrames > 0) {
+        setup();
+        runLightBenchmark(benchmarkFrames);
+        cleanup();
+        writeTrace(tracePath);
+        return 0;
+    }
 
-    app.run(
-        []() { setup(); },
-        [window](float deltaTime) { update(window, deltaTime); },
-        []() { render(); }
-    );
+    if (normalBenchmarkFrames > 0) {
+        if (extraDesks == 0) extraDesks = 5000;
+        setup();
+        runNormalBenchmark(normalBenchmarkFrames);
+        cleanup();
+        writeTrace(tracePath);
+        return 0;
+    }
+
+    if (jobBenchmarkFrames > 0) {
+        if (extraDesks == 0) extraDesks = 5000;
+        setup();
+        runJobBenchmark(jobBenchmarkFrames);
+        cleanup();
+        writeTrace(tracePath);
+        return 0;
+    }
+
+    if (pipelined) {
+        app.runPipelined(
+            []() { setup(); },
+            [window](float deltaTime) { update(window, deltaTime); },
+            [&app](int slot) { recordFrame(packets[slot], app.interpolationAlpha()); },
+            [](int slot) { render(packets[slot]); }
+        );
+    }
+    else {
+        app.run(
+            []() { setup(); },
+            [window](float deltaTime) { update(window, deltaTime); },
+            [&app]() {
+                recordFrame(packets[0], app.interpolationAlpha());
+                render(packets[0]);
+            }
+        );
+    }
 
     cleanup();
+    writeTrace(tracePath);
 
-    return 0;
+    return app.exitCode();
 }
 
 void processInput(GLFWwindow* window, float deltaTime)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
     // Standard Movement (W, A, S, D) + Up/Down (E, R)
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camera.ProcessKeyboard(RIGHT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) camera.ProcessKeyboard(UP, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) camera.ProcessKeyboard(DOWN, deltaTime);
+    if (Application::getKey(window, GLFW_KEY_W) == GLFW_PRESS) camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (Application::getKey(window, GLFW_KEY_S) == GLFW_PRESS) camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (Application::getKey(window, GLFW_KEY_A) == GLFW_PRESS) camera.ProcessKeyboard(LEFT, deltaTime);
+    if (Application::getKey(window, GLFW_KEY_D) == GLFW_PRESS) camera.ProcessKeyboard(RIGHT, deltaTime);
+    if (Application::getKey(window, GLFW_KEY_E) == GLFW_PRESS) camera.ProcessKeyboard(UP, deltaTime);
+    if (Application::getKey(window, GLFW_KEY_R) == GLFW_PRESS) camera.ProcessKeyboard(DOWN, deltaTime);
 
     // Pitch Key x - rotate up/down
-    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_X) == GLFW_PRESS && Application::getKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS)
         camera.ProcessPitch(30.0f * deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_X) == GLFW_PRESS && Application::getKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
         camera.ProcessPitch(-30.0f * deltaTime);
 
     // Yaw Key y - rotate left/right
-    if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_Y) == GLFW_PRESS && Application::getKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS)
         camera.ProcessYaw(30.0f * deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_Y) == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_Y) == GLFW_PRESS && Application::getKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
         camera.ProcessYaw(-30.0f * deltaTime);
 
     // Roll Key z - tilt camera
-    if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_Z) == GLFW_PRESS && Application::getKey(window, GLFW_KEY_LEFT_SHIFT) != GLFW_PRESS)
         camera.ProcessRoll(30.0f * deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS && glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (Application::getKey(window, GLFW_KEY_Z) == GLFW_PRESS && Application::getKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
         camera.ProcessRoll(-30.0f * deltaTime);
 
     // Fan Control (Key G)
     static bool gPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !gPressed) {
+    if (Application::getKey(window, GLFW_KEY_G) == GLFW_PRESS && !gPressed) {
         fanOn = !fanOn;
         gPressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE) gPressed = false;
+    if (Application::getKey(window, GLFW_KEY_G) == GLFW_RELEASE) gPressed = false;
 
     // Ceiling Lamp Rotation Control (Key H)
-    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+    if (Application::getKey(window, GLFW_KEY_H) == GLFW_PRESS) {
         lampRotation += 100.0f * deltaTime;
         if (lampRotation > 360.0f) lampRotation -= 360.0f;
     }
 
     // Ceiling Lamp Swing Control (Key P)
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS) {
+    if (Application::getKey(window, GLFW_KEY_P) == GLFW_PRESS) {
         lampSwingAngle += 50.0f * deltaTime;
         if (lampSwingAngle > 30.0f) lampSwingAngle = 30.0f; // Limit swing angle
     }
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE && lampSwingAngle > 0.0f) {
+    if (Application::getKey(window, GLFW_KEY_P) == GLFW_RELEASE && lampSwingAngle > 0.0f) {
         lampSwingAngle -= 50.0f * deltaTime;
         if (lampSwingAngle < 0.0f) lampSwingAngle = 0.0f;
     }
 
     // Door Control (Key Space for easy access, or define custom)
     static bool spacePressed = false;
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !spacePressed) {
+    if (Application::getKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !spacePressed) {
         doorOpen = !doorOpen;
         spacePressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE) spacePressed = false;
+    if (Application::getKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE) spacePressed = false;
 
     // ========================================
     // LIGHTING CONTROLS
@@ -451,60 +1283,94 @@ void processInput(GLFWwindow* window, float deltaTime)
 
     // Directional Light Toggle (Key 1)
     static bool key1Pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS && !key1Pressed) {
+    if (Application::getKey(window, GLFW_KEY_1) == GLFW_PRESS && !key1Pressed) {
         directionalLightOn = !directionalLightOn;
         cout << "Directional Light: " << (directionalLightOn ? "ON" : "OFF") << endl;
         key1Pressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_RELEASE) key1Pressed = false;
+    if (Application::getKey(window, GLFW_KEY_1) == GLFW_RELEASE) key1Pressed = false;
 
     // Point Lights Toggle (Key 2)
     static bool key2Pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS && !key2Pressed) {
+    if (Application::getKey(window, GLFW_KEY_2) == GLFW_PRESS && !key2Pressed) {
         pointLightOn = !pointLightOn;
         cout << "Point Lights: " << (pointLightOn ? "ON" : "OFF") << endl;
         key2Pressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_RELEASE) key2Pressed = false;
+    if (Application::getKey(window, GLFW_KEY_2) == GLFW_RELEASE) key2Pressed = false;
 
     // Spot Light Toggle (Key 3)
     static bool key3Pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS && !key3Pressed) {
+    if (Application::getKey(window, GLFW_KEY_3) == GLFW_PRESS && !key3Pressed) {
         spotLightOn = !spotLightOn;
         cout << "Spot Light: " << (spotLightOn ? "ON" : "OFF") << endl;
         key3Pressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_RELEASE) key3Pressed = false;
+    if (Application::getKey(window, GLFW_KEY_3) == GLFW_RELEASE) key3Pressed = false;
 
     // Ambient Toggle (Key 5)
     static bool key5Pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS && !key5Pressed) {
+    if (Application::getKey(window, GLFW_KEY_5) == GLFW_PRESS && !key5Pressed) {
         ambientOn = !ambientOn;
         cout << "Ambient: " << (ambientOn ? "ON" : "OFF") << endl;
         key5Pressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_5) == GLFW_RELEASE) key5Pressed = false;
+    if (Application::getKey(window, GLFW_KEY_5) == GLFW_RELEASE) key5Pressed = false;
 
     // Diffuse Toggle (Key 6)
     static bool key6Pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS && !key6Pressed) {
+    if (Application::getKey(window, GLFW_KEY_6) == GLFW_PRESS && !key6Pressed) {
         diffuseOn = !diffuseOn;
         cout << "Diffuse: " << (diffuseOn ? "ON" : "OFF") << endl;
         key6Pressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_6) == GLFW_RELEASE) key6Pressed = false;
+    if (Application::getKey(window, GLFW_KEY_6) == GLFW_RELEASE) key6Pressed = false;
 
     // Specular Toggle (Key 7)
     static bool key7Pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS && !key7Pressed) {
+    if (Application::getKey(window, GLFW_KEY_7) == GLFW_PRESS && !key7Pressed) {
         specularOn = !specularOn;
         cout << "Specular: " << (specularOn ? "ON" : "OFF") << endl;
         key7Pressed = true;
     }
-    if (glfwGetKey(window, GLFW_KEY_7) == GLFW_RELEASE) key7Pressed = false;
+    if (Application::getKey(window, GLFW_KEY_7) == GLFW_RELEASE) key7Pressed = false;
+
+    // Clustered / Brute-force Point Lights Toggle (Key C)
+    static bool keyCPressed = false;
+    if (Application::getKey(window, GLFW_KEY_C) == GLFW_PRESS && !keyCPressed) {
+        clusteredLighting = !clusteredLighting;
+        cout << "Point Light Path: " << (clusteredLighting ? "CLUSTERED" : "BRUTE FORCE") << endl;
+        keyCPressed = true;
+    }
+    if (Application::getKey(window, GLFW_KEY_C) == GLFW_RELEASE) keyCPressed = false;
+
+    // Frustum Culling Toggle (Key V)
+    static bool keyVPressed = false;
+    if (Application::getKey(window, GLFW_KEY_V) == GLFW_PRESS && !keyVPressed) {
+        frustumCulling = !frustumCulling;
+        cout << "Frustum Culling: " << (frustumCulling ? "ON" : "OFF") << endl;
+        keyVPressed = true;
+    }
+    if (Application::getKey(window, GLFW_KEY_V) == GLFW_RELEASE) keyVPressed = false;
+
+    // Pick along the view direction and query the neighbourhood (Key I)
+    static bool keyIPressed = false;
+    if (Application::getKey(window, GLFW_KEY_I) == GLFW_PRESS && !keyIPressed) {
+        float distance = 0.0f;
+        int picked = sceneBvh.raycast(camera.Position, camera.Front, distance);
+        int nearby = 0;
+        sceneBvh.querySphere(camera.Position, 2.0f, [&nearby](int) { nearby++; });
+        if (picked >= 0)
+            cout << "Looking at object " << picked << " (" << objectDraws[picked].count << " parts) at " << distance << " m";
+        else
+            cout << "Looking at nothing";
+        cout << ", " << nearby << " objects within 2 m" << endl;
+        keyIPressed = true;
+    }
+    if (Application::getKey(window, GLFW_KEY_I) == GLFW_RELEASE) keyIPressed = false;
 
     // Bird's Eye View (Key B)
-    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS) {
+    if (Application::getKey(window, GLFW_KEY_B) == GLFW_PRESS) {
         camera.Position = glm::vec3(0.0f, 10.0f, 0.0f);
         camera.Yaw = -90.0f;
         camera.Pitch = -90.0f;
@@ -513,7 +1379,7 @@ void processInput(GLFWwindow* window, float deltaTime)
     }
 
     // Look At Rotation (Key F) - Orbit around 0,0,0
-    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
+    if (Application::getKey(window, GLFW_KEY_F) == GLFW_PRESS) {
         float radius = 10.0f;
         orbitAngle += 50.0f * deltaTime;
         float camX = sin(glm::radians(orbitAngle)) * radius;
@@ -0,0 +1,158 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "VertexCompression.h"
+
+// CPU-side geometry for one mesh.
+// Interleaved position + normal (6 floats per vertex); MeshArena packs it for the GPU.
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Where a mesh lives inside the arena buffers
+struct MeshRange {
+    int baseVertex;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    VertexCompression::Decode decode;   // from the packed positions to object space
+};
+
+// GPU vertex: the position as 16-bit normalized integers against the mesh's
+// box and the normal octahedral-encoded in two bytes, 8 bytes where the
+// floats take 24
+struct PackedVertex {
+    int16_t position[3];
+    int8_t normal[2];
+};
+
+// One vertex buffer, one index buffer and one VAO shared by every static mesh.
+// Meshes are appended with add() and drawn by RenderQueue with base-vertex draws,
+// so switching meshes never changes the VAO or buffer bindings. The arena VAO is
+// the only VAO in this app: render() binds it once per frame and it stays bound.
+// The GPU gets PackedVertex, decoded by vertexShader.vs with the per-draw
+// decode RenderQueue passes along; the float copy stays for the software rasterizer.
+class MeshArena {
+public:
+    static MeshArena& get() {
+        static MeshArena arena;
+        return arena;
+    }
+
+    // Append a mesh; the GPU copy is refreshed on the next bind()
+    MeshRange add(const MeshData& data) {
+        MeshRange range;
+        range.baseVertex = (int)(vertices.size() / 6);
+        range.firstIndex = (unsigned int)indices.size();
+        range.indexCount = (unsigned int)data.indices.size();
+
+        size_t count = data.vertices.size() / 6;
+        range.decode = VertexCompression::fit(data.vertices.data(), count, 6);
+        for (size_t i = 0; i < count; i++) {
+            const float* in = &data.vertices[i * 6];
+            glm::vec3 position(in[0], in[1], in[2]), normal(in[3], in[4], in[5]);
+            PackedVertex vertex;
+            VertexCompression::packPosition(position, range.decode, vertex.position);
+            VertexCompression::packNormal(normal, vertex.normal);
+            error.addPosition(position, vertex.position, range.decode);
+            error.addNormal(normal, vertex.normal);
+            packed.push_back(vertex);
+        }
+
+        vertices.insert(vertices.end(), data.vertices.begin(), data.vertices.end());
+        indices.insert(indices.end(), data.indices.begin(), data.indices.end());
+        dirty = true;
+        return range;
+    }
+
+    // Make the arena VAO current, uploading any meshes added since the last bind
+    void bind() {
+        if (!VAO) create();
+        if (dirty) upload();
+        if (!bound) {
+            glBindVertexArray(VAO);
+            bound = true;
+        }
+    }
+
+    // Drop every mesh and the GL objects (called once nothing references the arena)
+    void reset() {
+        if (VAO) {
+            if (bound) glBindVertexArray(0);
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+            glDeleteBuffers(1, &EBO);
+        }
+        VAO = VBO = EBO = 0;
+        bound = false;
+        dirty = false;
+        vertices.clear();
+        packed.clear();
+        indices.clear();
+        error = VertexCompression::Error();
+    }
+
+    size_t vertexCount() const { return vertices.size() / 6; }
+    size_t indexCount() const { return indices.size(); }
+
+    // The CPU copy, for the software rasterizer
+    const std::vector<float>& vertexData() const { return vertices; }
+    const std::vector<unsigned int>& indexData() const { return indices; }
+
+    // Vertex buffer size as floats and as uploaded, and how far the packed
+    // vertices are from the floats (for --vertex-report)
+    size_t floatVertexBytes() const { return vertices.size() * sizeof(float); }
+    size_t packedVertexBytes() const { return packed.size() * sizeof(PackedVertex); }
+    const VertexCompression::Error& compressionError() const { return error; }
+
+private:
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    std::vector<float> vertices;
+    std::vector<PackedVertex> packed;
+    std::vector<unsigned int> indices;
+    VertexCompression::Error error;
+    bool dirty = false;
+    bool bound = false;
+
+    MeshArena() {}
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    void create() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // Position attribute (location = 0), unpacked to [-1, 1]
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+        glEnableVertexAttribArray(0);
+
+        // Octahedral normal attribute (location = 1), unpacked to [-1, 1]
+        glVertexAttribPointer(1, 2, GL_BYTE, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+        glEnableVertexAttribArray(1);
+
+        bound = true;
+    }
+
+    // Meshes are only added at startup, so the whole arena is re-uploaded
+    void upload() {
+        if (!bound) {
+            glBindVertexArray(VAO);
+            bound = true;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        dirty = false;
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <map>
+#include <functional>
+#include "MeshArena.h"
+#include "Bounds.h"
+
+// Primitive shapes known to the cache
+enum MeshType {
+    MESH_CUBE
+};
+
+// Identifies one tessellated mesh: the primitive type plus its generation
+// parameters (unused slots stay 0)
+struct MeshKey {
+    MeshType type;
+    float params[4];
+
+    MeshKey(MeshType t, float p0 = 0.0f, float p1 = 0.0f, float p2 = 0.0f, float p3 = 0.0f)
+        : type(t), params{ p0, p1, p2, p3 } {
+    }
+
+    bool operator<(const MeshKey& other) const {
+        if (type != other.type) return type < other.type;
+        for (int i = 0; i < 4; i++)
+            if (params[i] != other.params[i]) return params[i] < other.params[i];
+        return false;
+    }
+};
+
+// A cached mesh: its slice of the arena, shared by every primitive built with the same key
+struct Mesh {
+    MeshRange range;
+    Aabb bounds;        // object space, for culling
+    int refCount;
+};
+
+// Process-wide cache of procedural meshes. acquire() generates a mesh into the
+// arena the first time its key is seen and hands out the same Mesh afterwards;
+// release() drops it once the last user is gone.
+class MeshCache {
+public:
+    static MeshCache& get() {
+        static MeshCache cache;
+        return cache;
+    }
+
+    Mesh* acquire(const MeshKey& key, const std::function<void(MeshData&)>& build) {
+        auto it = meshes.find(key);
+        if (it != meshes.end()) {
+            it->second->refCount++;
+            return it->second;
+        }
+
+        MeshData data;
+        build(data);
+
+        Mesh* mesh = new Mesh();
+        mesh->range = MeshArena::get().add(data);
+        for (size_t i = 0; i + 2 < data.vertices.size(); i += 6)
+            mesh->bounds.add(glm::vec3(data.vertices[i], data.vertices[i + 1], data.vertices[i + 2]));
+        mesh->refCount = 1;
+
+        meshes[key] = mesh;
+        return mesh;
+    }
+
+    void release(Mesh* mesh) {
+        if (!mesh || --mesh->refCount > 0) return;
+
+        for (auto it = meshes.begin(); it != meshes.end(); ++it) {
+            if (it->second == mesh) {
+                meshes.erase(it);
+                break;
+            }
+        }
+
+        delete mesh;
+
+        // Arena space is not reused piecemeal; it is reclaimed once every mesh is gone
+        if (meshes.empty())
+            MeshArena::get().reset();
+    }
+
+    // Number of distinct meshes currently in the arena
+    size_t size() const { return meshes.size(); }
+
+private:
+    std::map<MeshKey, Mesh*> meshes;
+
+    MeshCache() {}
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
 #include "Cube.h"
+#include "SceneNode.h"
 
 class Monitor {
 public:
@@ -27,37 +28,37 @@ public:
         screenColor = screen;
     }
 
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz,
+    // Build the monitor under parent; returns its base node
+    SceneNode* build(SceneNode* parent, float tx, float ty, float tz,
         float rx = 0.0f, float ry = 0.0f, float rz = 0.0f) {
 
-        glm::mat4 monitorBase = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        monitorBase = glm::rotate(monitorBase, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-        monitorBase = glm::rotate(monitorBase, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-        monitorBase = glm::rotate(monitorBase, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
+        SceneNode* monitorBase = parent->addChild(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz));
 
         // Base/Stand bottom - wider oval-ish base
-        cube.draw(shader, monitorBase, -0.1f, 0.0f, -0.05f, 0.0f, 0.0f, 0.0f,
+        monitorBase->addPart(cube.getMesh(), -0.1f, 0.0f, -0.05f, 0.0f, 0.0f, 0.0f,
             0.25f, 0.02f, 0.18f, standColor);
 
         // Vertical pole/neck
-        cube.draw(shader, monitorBase, 0.0f, 0.02f, 0.02f, 0.0f, 0.0f, 0.0f,
+        monitorBase->addPart(cube.getMesh(), 0.0f, 0.02f, 0.02f, 0.0f, 0.0f, 0.0f,
             0.05f, 0.28f, 0.05f, standColor);
 
         // Back panel/frame (outer bezel)
-        cube.draw(shader, monitorBase, -0.24f, 0.30f, -0.01f, 0.0f, 0.0f, 0.0f,
+        monitorBase->addPart(cube.getMesh(), -0.24f, 0.30f, -0.01f, 0.0f, 0.0f, 0.0f,
             0.5f, 0.36f, 0.025f, bezelColor);
 
         // Screen display area (slightly inset from bezel)
-        cube.draw(shader, monitorBase, -0.22f, 0.32f, -0.012f, 0.0f, 0.0f, 0.0f,
+        monitorBase->addPart(cube.getMesh(), -0.22f, 0.32f, -0.012f, 0.0f, 0.0f, 0.0f,
             0.46f, 0.30f, 0.015f, screenColor);
 
         // Bottom bezel strip (thicker chin)
-        cube.draw(shader, monitorBase, -0.24f, 0.30f, -0.012f, 0.0f, 0.0f, 0.0f,
+        monitorBase->addPart(cube.getMesh(), -0.24f, 0.30f, -0.012f, 0.0f, 0.0f, 0.0f,
             0.5f, 0.025f, 0.02f, bezelColor);
 
         // Power LED indicator (small green dot)
-        cube.draw(shader, monitorBase, 0.0f, 0.305f, -0.015f, 0.0f, 0.0f, 0.0f,
+        monitorBase->addPart(cube.getMesh(), 0.0f, 0.305f, -0.015f, 0.0f, 0.0f, 0.0f,
             0.015f, 0.015f, 0.005f, glm::vec3(0.2f, 0.8f, 0.2f));
+
+        return monitorBase;
     }
 };
 
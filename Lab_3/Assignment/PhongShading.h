@@ -0,0 +1,108 @@
+#ifndef PHONG_SHADING_H
+#define PHONG_SHADING_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+#include "LightBlock.h"
+#include "ClusteredLights.h"
+
+// fragmentShader.fs in C++, for the software rasterizer. The flags stand in
+// for the permutation's defines. Point lights are always looped over in full,
+// like the shader's brute-force path; the clustered path skips lights only
+// where they add less than LightClusterGrid::CUTOFF_INTENSITY.
+struct PhongShading {
+    struct Material {
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+        float shininess;
+    };
+
+    bool directionalLight = true;
+    bool pointLights = true;
+    bool spotLight = true;
+    bool ambient = true;
+    bool diffuse = true;
+    bool specular = true;
+
+    const LightBlock* lights = nullptr;
+    const std::vector<PointLightData>* pointLightData = nullptr;
+    glm::vec3 viewPos = glm::vec3(0.0f);
+
+    glm::vec3 shade(const Material& material, const glm::vec3& fragPos, const glm::vec3& normal) const {
+        glm::vec3 N = glm::normalize(normal);
+        glm::vec3 V = glm::normalize(viewPos - fragPos);
+        glm::vec3 result(0.0f);
+
+        if (directionalLight)
+            result += directional(material, lights->directionalLight, N, V);
+        if (pointLights)
+            for (const PointLightData& light : *pointLightData)
+                result += point(material, light, N, fragPos, V);
+        if (spotLight)
+            result += spot(material, lights->spotLight, N, fragPos, V);
+
+        // Ensure minimum visibility if all lights are off
+        if (!directionalLight && !pointLights && !spotLight)
+            result = material.ambient * 0.1f;
+        return result;
+    }
+
+private:
+    // GLSL pow() of a clamped cosine
+    static float specularFactor(const glm::vec3& V, const glm::vec3& R, float shininess) {
+        return std::pow(glm::max(glm::dot(V, R), 0.0f), shininess);
+    }
+
+    glm::vec3 directional(const Material& mat, const DirectionalLightStd140& light, const glm::vec3& N, const glm::vec3& V) const {
+        glm::vec3 L = glm::normalize(-light.direction);
+        glm::vec3 R = glm::reflect(-L, N);
+
+        glm::vec3 result(0.0f);
+        if (ambient) result += mat.ambient * light.ambient;
+        if (diffuse) result += mat.diffuse * glm::max(glm::dot(N, L), 0.0f) * light.diffuse;
+        if (specular) result += mat.specular * specularFactor(V, R, mat.shininess) * light.specular;
+        return result;
+    }
+
+    glm::vec3 point(const Material& mat, const PointLightData& light, const glm::vec3& N, const glm::vec3& fragPos,
+        const glm::vec3& V) const {
+        glm::vec3 L = glm::normalize(light.position - fragPos);
+        glm::vec3 R = glm::reflect(-L, N);
+
+        float d = glm::length(light.position - fragPos);
+        float attenuation = 1.0f / (light.k_c + light.k_l * d + light.k_q * d * d);
+
+        glm::vec3 result(0.0f);
+        if (ambient) result += mat.ambient * light.ambient * attenuation;
+        if (diffuse) result += mat.diffuse * glm::max(glm::dot(N, L), 0.0f) * light.diffuse * attenuation;
+        if (specular) result += mat.specular * specularFactor(V, R, mat.shininess) * light.specular * attenuation;
+        return result;
+    }
+
+    glm::vec3 spot(const Material& mat, const SpotLightStd140& light, const glm::vec3& N, const glm::vec3& fragPos,
+        const glm::vec3& V) const {
+        glm::vec3 L = glm::normalize(light.position - fragPos);
+        glm::vec3 R = glm::reflect(-L, N);
+
+        // Outside the cone only a dimmed ambient term remains
+        float theta = glm::dot(L, glm::normalize(-light.direction));
+        if (theta < light.cutOff)
+            return ambient ? mat.ambient * light.ambient * 0.1f : glm::vec3(0.0f);
+
+        float d = glm::length(light.position - fragPos);
+        float attenuation = 1.0f / (light.k_c + light.k_l * d + light.k_q * d * d);
+
+        // Intensity based on angle (soft edge)
+        float intensity = glm::clamp((theta - light.cutOff) / (1.0f - light.cutOff), 0.0f, 1.0f);
+
+        glm::vec3 result(0.0f);
+        if (ambient) result += mat.ambient * light.ambient * attenuation;
+        if (diffuse) result += mat.diffuse * glm::max(glm::dot(N, L), 0.0f) * light.diffuse * attenuation * intensity;
+        if (specular) result += mat.specular * specularFactor(V, R, mat.shininess) * light.specular * attenuation * intensity;
+        return result;
+    }
+};
+
+#endif
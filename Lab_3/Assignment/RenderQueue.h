@@ -0,0 +1,267 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include "MeshArena.h"
+
+// Layout fixed by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+// Per-draw attributes read by vertexShader.vs
+// location 2-5 : model matrix (one vec4 column per location)
+// location 6   : material ambient
+// location 7   : material diffuse
+// location 8   : material specular (w = shininess)
+// location 9-11: normal matrix (one column per location, w unused)
+// location 12  : packed position scale (the mesh's decode, see MeshArena.h)
+// location 13  : packed position offset
+struct DrawData {
+    glm::mat4 model;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 normalMatrix[3];
+    glm::vec4 positionScale;
+    glm::vec4 positionOffset;
+};
+
+// Inverse transpose of the model's upper 3x3, computed once per draw instead
+// of once per vertex. When the columns are orthogonal (a rotation times a
+// scale along each axis, uniform or not: every part of the scene graph unless
+// a parent is scaled non-uniformly) the inverse transpose is each column over
+// its squared length, and true is returned. Anything else takes a 3x3 inverse.
+inline bool computeNormalMatrix(const glm::mat4& model, glm::vec4 normalMatrix[3]) {
+    glm::vec3 c0(model[0]), c1(model[1]), c2(model[2]);
+    float l0 = glm::dot(c0, c0), l1 = glm::dot(c1, c1), l2 = glm::dot(c2, c2);
+    float d01 = glm::dot(c0, c1), d02 = glm::dot(c0, c2), d12 = glm::dot(c1, c2);
+
+    // |cos| of every pair below 1e-4
+    const float tolerance = 1e-8f;
+    if (l0 > 0.0f && l1 > 0.0f && l2 > 0.0f &&
+        d01 * d01 <= tolerance * l0 * l1 && d02 * d02 <= tolerance * l0 * l2 && d12 * d12 <= tolerance * l1 * l2) {
+        normalMatrix[0] = glm::vec4(c0 / l0, 0.0f);
+        normalMatrix[1] = glm::vec4(c1 / l1, 0.0f);
+        normalMatrix[2] = glm::vec4(c2 / l2, 0.0f);
+        return true;
+    }
+
+    glm::mat3 general = glm::transpose(glm::inverse(glm::mat3(model)));
+    for (int i = 0; i < 3; i++)
+        normalMatrix[i] = glm::vec4(general[i], 0.0f);
+    return false;
+}
+
+// A run of consecutive recorded draws
+struct DrawRange {
+    size_t first;
+    size_t count;
+};
+
+// The draws of one frame, recorded on the CPU. One list can be filled (on any
+// thread) while the render thread uploads and submits another.
+struct DrawList {
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawData> drawData;
+
+    void add(const MeshRange& range, const glm::mat4& model, const glm::vec3& ambient,
+        const glm::vec3& diffuse, const glm::vec3& specular, float shininess) {
+        resize(size() + 1);
+        set(size() - 1, range, model, ambient, diffuse, specular, shininess);
+    }
+
+    // Fill draw 'index' of a list sized with resize(). Different threads may
+    // fill different draws at the same time.
+    void set(size_t index, const MeshRange& range, const glm::mat4& model, const glm::vec3& ambient,
+        const glm::vec3& diffuse, const glm::vec3& specular, float shininess) {
+        DrawElementsIndirectCommand& command = commands[index];
+        command.count = range.indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = range.firstIndex;
+        command.baseVertex = range.baseVertex;
+        command.baseInstance = (unsigned int)index;
+
+        DrawData& data = drawData[index];
+        data.model = model;
+        data.ambient = glm::vec4(ambient, 0.0f);
+        data.diffuse = glm::vec4(diffuse, 0.0f);
+        data.specular = glm::vec4(specular, shininess);
+        computeNormalMatrix(model, data.normalMatrix);
+        data.positionScale = glm::vec4(range.decode.scale, 0.0f);
+        data.positionOffset = glm::vec4(range.decode.offset, 0.0f);
+    }
+
+    void resize(size_t count) {
+        commands.resize(count);
+        drawData.resize(count);
+    }
+
+    void clear() {
+        commands.clear();
+        drawData.clear();
+    }
+
+    size_t size() const { return commands.size(); }
+};
+
+// Records every draw of a frame once and submits the whole list per viewport.
+// add() appends to the list chosen with recordInto(); upload() makes a list the
+// one that submit() draws, so recording the next frame can overlap drawing this one.
+// Each command draws one instance whose baseInstance selects its DrawData, so
+// on GL 4.3+ the scene goes out in a single glMultiDrawElementsIndirect call.
+// On GL 3.3 the same commands are replayed in a loop, re-pointing the per-draw
+// attributes at the command's DrawData before each glDrawElementsBaseVertex.
+class RenderQueue {
+public:
+    // False forces the GL 3.3 loop even when multi-draw indirect is available
+    bool multiDraw = true;
+
+    // GL draw calls issued by submit(); reset by whoever reports it
+    size_t glDrawCalls = 0;
+
+    static RenderQueue& get() {
+        static RenderQueue queue;
+        return queue;
+    }
+
+    // Where add() records from now on (the queue's own list until this is called)
+    void recordInto(DrawList& list) { recording = &list; }
+    DrawList& recordingList() { return *recording; }
+
+    void add(const MeshRange& range, const glm::mat4& model, const glm::vec3& ambient,
+        const glm::vec3& diffuse, const glm::vec3& specular, float shininess) {
+        recording->add(range, model, ambient, diffuse, specular, shininess);
+    }
+
+    // Upload a recorded list (once per frame, after recording); submit() draws it
+    void upload(const DrawList& list) {
+        if (!drawVBO) create();
+        uploaded = &list;
+
+        glBindBuffer(GL_ARRAY_BUFFER, drawVBO);
+        glBufferData(GL_ARRAY_BUFFER, list.drawData.size() * sizeof(DrawData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, list.drawData.size() * sizeof(DrawData), list.drawData.data());
+
+        if (useMultiDraw()) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, list.commands.size() * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, list.commands.size() * sizeof(DrawElementsIndirectCommand), list.commands.data());
+        }
+    }
+
+    void upload() { upload(*recording); }
+
+    // Draw everything uploaded this frame with the current shader state
+    void submit() {
+        if (uploaded->commands.empty()) return;
+        MeshArena::get().bind();
+        submitRange(0, uploaded->commands.size());
+        if (!useMultiDraw()) pointDrawAttributes(0);
+    }
+
+    // Draw only the given runs of recorded commands (e.g. the objects that
+    // survived culling). The uploaded buffers are shared with submit(): each run
+    // is one multi-draw call starting part-way into the command buffer.
+    void submit(const std::vector<DrawRange>& ranges) {
+        if (ranges.empty()) return;
+        MeshArena::get().bind();
+        for (const DrawRange& range : ranges)
+            submitRange(range.first, range.count);
+        if (!useMultiDraw()) pointDrawAttributes(0);
+    }
+
+    // Forget the draws recorded so far
+    void clear() {
+        recording->clear();
+    }
+
+    void reset() {
+        if (drawVBO) {
+            glDeleteBuffers(1, &drawVBO);
+            glDeleteBuffers(1, &commandBuffer);
+        }
+        drawVBO = commandBuffer = 0;
+        ownList.clear();
+        recording = &ownList;
+        uploaded = &ownList;
+    }
+
+    bool useMultiDraw() const { return multiDraw && GLAD_GL_VERSION_4_3; }
+
+    // Draws in the list being recorded
+    size_t drawCount() const { return recording->size(); }
+
+    // Draws in the list submit() draws
+    size_t uploadedCount() const { return uploaded->size(); }
+
+private:
+    unsigned int drawVBO = 0;
+    unsigned int commandBuffer = 0;
+    DrawList ownList;
+    DrawList* recording = &ownList;
+    const DrawList* uploaded = &ownList;
+
+    RenderQueue() {}
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    void submitRange(size_t first, size_t count) {
+        if (useMultiDraw()) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                (void*)(first * sizeof(DrawElementsIndirectCommand)), (GLsizei)count, 0);
+            glDrawCalls++;
+            return;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, drawVBO);
+        for (size_t i = first; i < first + count; i++) {
+            const DrawElementsIndirectCommand& command = uploaded->commands[i];
+            pointDrawAttributes(i * sizeof(DrawData));
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                (void*)(command.firstIndex * sizeof(unsigned int)), command.baseVertex);
+            glDrawCalls++;
+        }
+    }
+
+    // Hook the per-draw attributes into the arena VAO
+    void create() {
+        glGenBuffers(1, &drawVBO);
+        glGenBuffers(1, &commandBuffer);
+
+        MeshArena::get().bind();
+        glBindBuffer(GL_ARRAY_BUFFER, drawVBO);
+        for (int location = 2; location <= 13; location++) {
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+        pointDrawAttributes(0);
+    }
+
+    // Point locations 2-13 at the DrawData starting 'offset' bytes into drawVBO
+    void pointDrawAttributes(size_t offset) {
+        for (int i = 0; i < 4; i++) {
+            glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(DrawData),
+                (void*)(offset + offsetof(DrawData, model) + i * sizeof(glm::vec4)));
+        }
+        glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData), (void*)(offset + offsetof(DrawData, ambient)));
+        glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData), (void*)(offset + offsetof(DrawData, diffuse)));
+        glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(DrawData), (void*)(offset + offsetof(DrawData, specular)));
+        for (int i = 0; i < 3; i++) {
+            glVertexAttribPointer(9 + i, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData),
+                (void*)(offset + offsetof(DrawData, normalMatrix) + i * sizeof(glm::vec4)));
+        }
+        glVertexAttribPointer(12, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData), (void*)(offset + offsetof(DrawData, positionScale)));
+        glVertexAttribPointer(13, 3, GL_FLOAT, GL_FALSE, sizeof(DrawData), (void*)(offset + offsetof(DrawData, positionOffset)));
+    }
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef SCENE_NODE_H
+#define SCENE_NODE_H
+
+#include <atomic>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "MeshCache.h"
+#include "Bounds.h"
+
+// A node of the scene graph: a local translate -> rotateX -> rotateY -> rotateZ -> scale
+// transform (the same chain Cube::draw builds), an optional mesh drawn at the node,
+// and children. Local and world matrices are cached; changing a node marks it and
+// its subtree dirty, so a frame only recomputes the matrices of nodes that moved.
+// World bounds of a subtree are cached the same way; a change also dirties the
+// bounds of every ancestor.
+class SceneNode {
+public:
+    Mesh* mesh = nullptr;                // nullptr for pure transform nodes
+    glm::vec3 color = glm::vec3(1.0f);
+
+    // World matrices recomputed since the counter was last cleared (by any thread)
+    static inline std::atomic<unsigned int> matrixUpdates{ 0 };
+
+    SceneNode() {}
+
+    ~SceneNode() {
+        for (SceneNode* child : children)
+            delete child;
+    }
+
+    // Add a pure transform node (a pivot or the base of a composite object)
+    SceneNode* addChild(glm::vec3 translation = glm::vec3(0.0f), glm::vec3 rotation = glm::vec3(0.0f),
+        glm::vec3 scale = glm::vec3(1.0f)) {
+        SceneNode* child = new SceneNode();
+        child->parent = this;
+        child->translation = translation;
+        child->rotation = rotation;
+        child->scale = scale;
+        children.push_back(child);
+        child->markAncestorBoundsDirty();
+        return child;
+    }
+
+    // Add a drawable part; arguments mirror Cube::draw
+    SceneNode* addPart(Mesh* partMesh, float tx, float ty, float tz, float rx, float ry, float rz,
+        float sx, float sy, float sz, glm::vec3 partColor) {
+        SceneNode* part = addChild(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz), glm::vec3(sx, sy, sz));
+        part->mesh = partMesh;
+        part->color = partColor;
+        return part;
+    }
+
+    // Setters only dirty the node when the value actually changes
+    void setTranslation(glm::vec3 value) {
+        if (value == translation) return;
+        translation = value;
+        markLocalDirty();
+    }
+
+    void setRotation(glm::vec3 degrees) {
+        if (degrees == rotation) return;
+        rotation = degrees;
+        markLocalDirty();
+    }
+
+    void setScale(glm::vec3 value) {
+        if (value == scale) return;
+        scale = value;
+        markLocalDirty();
+    }
+
+    // Transform applied above a root node (ignored for nodes with a parent)
+    void setParentMatrix(const glm::mat4& matrix) {
+        if (matrix == parentMatrix) return;
+        parentMatrix = matrix;
+        markWorldDirty();
+        markAncestorBoundsDirty();
+    }
+
+    const glm::mat4& getWorld() {
+        if (worldDirty) {
+            if (localDirty) {
+                glm::mat4 t = glm::translate(glm::mat4(1.0f), translation);
+                glm::mat4 rX = glm::rotate(t, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+                glm::mat4 rY = glm::rotate(rX, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+                glm::mat4 rZ = glm::rotate(rY, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+                local = glm::scale(rZ, scale);
+                localDirty = false;
+            }
+            world = (parent ? parent->getWorld() : parentMatrix) * local;
+            worldDirty = false;
+            matrixUpdates.fetch_add(1, std::memory_order_relaxed);
+        }
+        return world;
+    }
+
+    // World-space box around every mesh in this subtree (empty without meshes)
+    const Aabb& getBounds() {
+        if (boundsDirty) {
+            bounds = mesh ? mesh->bounds.transformed(getWorld()) : Aabb();
+            for (SceneNode* child : children)
+                bounds.add(child->getBounds());
+            boundsDirty = false;
+        }
+        return bounds;
+    }
+
+    const std::vector<SceneNode*>& getChildren() const { return children; }
+
+    // Call visit(node) for every node in this subtree that has a mesh
+    template <typename Visit>
+    void visitDrawables(Visit&& visit) {
+        if (mesh) visit(*this);
+        for (SceneNode* child : children)
+            child->visitDrawables(visit);
+    }
+
+    size_t nodeCount() const {
+        size_t count = 1;
+        for (const SceneNode* child : children)
+            count += child->nodeCount();
+        return count;
+    }
+
+private:
+    SceneNode* parent = nullptr;
+    std::vector<SceneNode*> children;
+
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::mat4 parentMatrix = glm::mat4(1.0f);
+
+    glm::mat4 local = glm::mat4(1.0f);
+    glm::mat4 world = glm::mat4(1.0f);
+    bool localDirty = true;
+    bool worldDirty = true;
+
+    Aabb bounds;
+    bool boundsDirty = true;
+
+    SceneNode(const SceneNode&) = delete;
+    SceneNode& operator=(const SceneNode&) = delete;
+
+    void markLocalDirty() {
+        localDirty = true;
+        markWorldDirty();
+        markAncestorBoundsDirty();
+    }
+
+    // A dirty node's subtree is already dirty, so propagation stops there
+    void markWorldDirty() {
+        if (worldDirty) return;
+        worldDirty = true;
+        boundsDirty = true;
+        for (SceneNode* child : children)
+            child->markWorldDirty();
+    }
+
+    void markAncestorBoundsDirty() {
+        for (SceneNode* node = parent; node && !node->boundsDirty; node = node->parent)
+            node->boundsDirty = true;
+    }
+};
+
+#endif
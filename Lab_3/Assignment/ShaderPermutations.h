@@ -0,0 +1,73 @@
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+#include <glad/glad.h>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "shader.h"
+
+// One program per combination of feature #defines, compiled the first time the
+// combination is asked for. Bit i of a mask enables features[i], so n features
+// give 2^n possible programs, of which only the ones actually used get built.
+// onCompile runs once per new program (uniform block bindings, sampler units).
+class ShaderPermutations {
+public:
+    ShaderPermutations(const char* vertexShaderPath, const char* fragmentShaderPath,
+        const std::vector<const char*>& featureNames, std::function<void(Shader&)> compiled = nullptr)
+        : vertexPath(vertexShaderPath), fragmentPath(fragmentShaderPath), features(featureNames),
+        onCompile(compiled), programs((size_t)1 << featureNames.size(), nullptr) {
+    }
+
+    ~ShaderPermutations() {
+        for (Shader* program : programs) {
+            if (!program) continue;
+            glDeleteProgram(program->ID);
+            delete program;
+        }
+    }
+
+    Shader& get(unsigned int mask) {
+        Shader*& program = programs[mask];
+        if (!program) {
+            program = new Shader(vertexPath.c_str(), fragmentPath.c_str(), defines(mask));
+            compiledCount++;
+            if (onCompile) onCompile(*program);
+            std::cout << "Compiled shader variant " << describe(mask) << " ("
+                << compiledCount << " of " << programs.size() << ")" << std::endl;
+        }
+        return *program;
+    }
+
+    size_t compiled() const { return compiledCount; }
+    size_t variantCount() const { return programs.size(); }
+
+    // "#define NAME" lines for the features in 'mask'
+    std::string defines(unsigned int mask) const {
+        std::string text;
+        for (size_t i = 0; i < features.size(); i++)
+            if (mask & (1u << i)) text += std::string("#define ") + features[i] + "\n";
+        return text;
+    }
+
+    std::string describe(unsigned int mask) const {
+        std::string text;
+        for (size_t i = 0; i < features.size(); i++)
+            if (mask & (1u << i)) text += (text.empty() ? "" : "+") + std::string(features[i]);
+        return text.empty() ? "(no features)" : text;
+    }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<const char*> features;
+    std::function<void(Shader&)> onCompile;
+    std::vector<Shader*> programs;
+    size_t compiledCount = 0;
+
+    ShaderPermutations(const ShaderPermutations&) = delete;
+    ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+};
+
+#endif
@@ -0,0 +1,567 @@
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RASTERIZER_SSE2 1
+#endif
+
+// CPU rasterizer for machines without a GPU, and a deterministic reference
+// image for the GL renderer. draw() runs in two parallel stages:
+//
+//   geometry  the draws are split into batches. A batch runs the vertex
+//             function, clips its triangles in clip space and bins each one
+//             into the TILE_SIZE tiles it touches.
+//   raster    one job per tile walks every batch's bin for that tile in
+//             submission order, so the image never depends on the thread
+//             count. Edge functions are exact integers (1/16 pixel) tested
+//             four pixels at a time with SSE2. Each BLOCK_SIZE block keeps
+//             its farthest depth, and triangles behind it skip the block.
+//
+// Covered pixels that pass the depth test (GL_LESS) call the fragment
+// function with the perspective-correct varyings. Conventions follow GL:
+// window origin bottom-left, depth range [0, 1], no face culling, top-left
+// fill rule.
+class SoftwareRasterizer {
+public:
+    static constexpr int TILE_SIZE = 64;
+    static constexpr int BLOCK_SIZE = 8;
+    static constexpr int MAX_VARYINGS = 6;
+    static constexpr int SUBPIXELS = 16;
+    // Triangles are clipped this far (in pixels) outside the viewport, which
+    // keeps fixed-point coordinates within 18 bits
+    static constexpr float GUARD_BAND = 4096.0f;
+    // Geometry batches per thread, so threads that finish early can steal
+    static constexpr int BATCHES_PER_THREAD = 4;
+
+    // Output of the vertex function
+    struct Vertex {
+        glm::vec4 position;   // clip space
+        float varyings[MAX_VARYINGS] = {};
+    };
+
+    struct Stats {
+        size_t triangles = 0;       // from the vertex function
+        size_t clipped = 0;         // crossed the near or far plane or the guard band
+        size_t setUp = 0;           // reached the tiles (after clipping and culling)
+        size_t binEntries = 0;      // triangle-in-tile pairs
+        size_t blocksSkipped = 0;   // blocks rejected by hierarchical Z
+        size_t fragments = 0;       // fragments shaded
+
+        void add(const Stats& other) {
+            triangles += other.triangles;
+            clipped += other.clipped;
+            setUp += other.setUp;
+            binEntries += other.binEntries;
+            blocksSkipped += other.blocksSkipped;
+            fragments += other.fragments;
+        }
+    };
+
+private:
+    // A triangle ready for the tiles. Edge i is e = a * x + b * y + c at the
+    // pixel centre (x, y) in subpixels; it is >= 0 inside. Planes hold depth,
+    // 1/w and each varying / w as value = p[0] + p[1] * px + p[2] * py.
+    struct Triangle {
+        int64_t c[3];
+        int32_t a[3], b[3];
+        int minX, minY, maxX, maxY;   // pixel bounds inside the scissor rectangle
+        float minDepth;
+        uint32_t draw;
+        double planes[2 + MAX_VARYINGS][3];
+    };
+
+public:
+    // Triangles of a run of draws; the geometry function feeds one of these
+    class Batch {
+    public:
+        // One triangle in clip space
+        void triangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, uint32_t draw) {
+            stats.triangles++;
+            const Vertex* input[3] = { &v0, &v1, &v2 };
+
+            // Entirely outside one side of the view volume
+            for (int plane = 0; plane < 6; plane++) {
+                bool outside = true;
+                for (int i = 0; i < 3 && outside; i++)
+                    outside = volumeDistance(input[i]->position, plane) < 0.0f;
+                if (outside) return;
+            }
+
+            bool inside = true;
+            for (int plane = 0; plane < 6 && inside; plane++)
+                for (int i = 0; i < 3 && inside; i++)
+                    inside = clipDistance(input[i]->position, plane) >= 0.0f;
+            if (inside) {
+                setup(input, draw);
+                return;
+            }
+
+            stats.clipped++;
+            Vertex polygon[2][9];
+            int count = 3;
+            for (int i = 0; i < 3; i++) polygon[0][i] = *input[i];
+            int current = 0;
+            for (int plane = 0; plane < 6 && count >= 3; plane++) {
+                const Vertex* in = polygon[current];
+                Vertex* out = polygon[current ^ 1];
+                int outCount = 0;
+                for (int i = 0; i < count; i++) {
+                    const Vertex& p = in[i];
+                    const Vertex& q = in[(i + 1) % count];
+                    float dp = clipDistance(p.position, plane), dq = clipDistance(q.position, plane);
+                    if (dp >= 0.0f) out[outCount++] = p;
+                    if ((dp >= 0.0f) != (dq >= 0.0f))
+                        out[outCount++] = lerp(p, q, dp / (dp - dq));
+                }
+                count = outCount;
+                current ^= 1;
+            }
+
+            const Vertex* fan[3] = { &polygon[current][0], nullptr, nullptr };
+            for (int i = 1; i + 1 < count; i++) {
+                fan[1] = &polygon[current][i];
+                fan[2] = &polygon[current][i + 1];
+                setup(fan, draw);
+            }
+        }
+
+        // Indexed triangles out of an interleaved vertex array, as glDrawElementsBaseVertex
+        // would read them. vertexShader(attributes, Vertex&) runs once per vertex used.
+        template <typename VertexShader>
+        void indexed(const float* vertices, size_t stride, const unsigned int* indices, unsigned int firstIndex,
+            unsigned int indexCount, int baseVertex, uint32_t draw, const VertexShader& vertexShader) {
+            if (indexCount < 3) return;
+            unsigned int lowest = ~0u, highest = 0;
+            for (unsigned int i = firstIndex; i < firstIndex + indexCount; i++) {
+                lowest = std::min(lowest, indices[i]);
+                highest = std::max(highest, indices[i]);
+            }
+
+            shaded.resize(highest - lowest + 1);
+            for (unsigned int v = lowest; v <= highest; v++)
+                vertexShader(vertices + (size_t)(baseVertex + (int)v) * stride, shaded[v - lowest]);
+
+            for (unsigned int i = firstIndex; i + 2 < firstIndex + indexCount; i += 3)
+                triangle(shaded[indices[i] - lowest], shaded[indices[i + 1] - lowest], shaded[indices[i + 2] - lowest], draw);
+        }
+
+    private:
+        friend class SoftwareRasterizer;
+
+        const SoftwareRasterizer* owner = nullptr;
+        std::vector<Vertex> shaded;
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<uint32_t>> bins;   // triangle indices per tile
+        Stats stats;
+
+        void reset(const SoftwareRasterizer* rasterizer) {
+            owner = rasterizer;
+            triangles.clear();
+            bins.resize(rasterizer->tileCount());
+            for (std::vector<uint32_t>& bin : bins) bin.clear();
+            stats = Stats();
+        }
+
+        // The view volume's planes: near, far, left, right, bottom, top
+        static float volumeDistance(const glm::vec4& p, int plane) {
+            switch (plane) {
+            case 0: return p.w + p.z;
+            case 1: return p.w - p.z;
+            case 2: return p.w + p.x;
+            case 3: return p.w - p.x;
+            case 4: return p.w + p.y;
+            default: return p.w - p.y;
+            }
+        }
+
+        // What triangles are clipped against: near and far, then the guard band
+        float clipDistance(const glm::vec4& p, int plane) const {
+            switch (plane) {
+            case 0: return p.w + p.z;
+            case 1: return p.w - p.z;
+            case 2: return owner->guardX * p.w + p.x;
+            case 3: return owner->guardX * p.w - p.x;
+            case 4: return owner->guardY * p.w + p.y;
+            default: return owner->guardY * p.w - p.y;
+            }
+        }
+
+        static Vertex lerp(const Vertex& p, const Vertex& q, float t) {
+            Vertex result;
+            result.position = p.position + (q.position - p.position) * t;
+            for (int i = 0; i < MAX_VARYINGS; i++)
+                result.varyings[i] = p.varyings[i] + (q.varyings[i] - p.varyings[i]) * t;
+            return result;
+        }
+
+        // Viewport transform, snapping, edge functions and planes, then binning
+        void setup(const Vertex* const input[3], uint32_t draw) {
+            const SoftwareRasterizer& r = *owner;
+            const Vertex* v[3] = { input[0], input[1], input[2] };
+            int64_t X[3], Y[3];
+            float depth[3], invW[3];
+            for (int i = 0; i < 3; i++) {
+                const glm::vec4& p = v[i]->position;
+                invW[i] = 1.0f / p.w;
+                float x = (float)r.viewportX + (p.x * invW[i] + 1.0f) * 0.5f * (float)r.viewportWidth;
+                float y = (float)r.viewportY + (p.y * invW[i] + 1.0f) * 0.5f * (float)r.viewportHeight;
+                X[i] = (int64_t)std::llround(x * SUBPIXELS);
+                Y[i] = (int64_t)std::llround(y * SUBPIXELS);
+                depth[i] = p.z * invW[i] * 0.5f + 0.5f;
+            }
+
+            // Twice the signed area in subpixels squared; clockwise triangles are turned round
+            int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+            if (area == 0) return;
+            if (area < 0) {
+                std::swap(v[1], v[2]);
+                std::swap(X[1], X[2]);
+                std::swap(Y[1], Y[2]);
+                std::swap(depth[1], depth[2]);
+                std::swap(invW[1], invW[2]);
+                area = -area;
+            }
+
+            // Pixels whose centre may be covered, inside the scissor rectangle
+            int64_t minX = std::min({ X[0], X[1], X[2] }), maxX = std::max({ X[0], X[1], X[2] });
+            int64_t minY = std::min({ Y[0], Y[1], Y[2] }), maxY = std::max({ Y[0], Y[1], Y[2] });
+            Triangle t;
+            t.minX = (int)std::max<int64_t>(r.viewportX, (minX - SUBPIXELS / 2 + SUBPIXELS - 1) >> 4);
+            t.maxX = (int)std::min<int64_t>(r.viewportX + r.viewportWidth - 1, (maxX - SUBPIXELS / 2) >> 4);
+            t.minY = (int)std::max<int64_t>(r.viewportY, (minY - SUBPIXELS / 2 + SUBPIXELS - 1) >> 4);
+            t.maxY = (int)std::min<int64_t>(r.viewportY + r.viewportHeight - 1, (maxY - SUBPIXELS / 2) >> 4);
+            if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+            for (int i = 0; i < 3; i++) {
+                int j = (i + 1) % 3, k = (i + 2) % 3;
+                t.a[i] = (int32_t)(Y[j] - Y[k]);
+                t.b[i] = (int32_t)(X[k] - X[j]);
+                t.c[i] = X[j] * Y[k] - Y[j] * X[k];
+                // Pixels exactly on a shared edge belong to the triangle left or above it
+                bool topLeft = t.a[i] > 0 || (t.a[i] == 0 && t.b[i] < 0);
+                if (!topLeft) t.c[i] -= 1;
+            }
+
+            double xs[3], ys[3];
+            for (int i = 0; i < 3; i++) {
+                xs[i] = (double)X[i] / SUBPIXELS;
+                ys[i] = (double)Y[i] / SUBPIXELS;
+            }
+            double determinant = (double)area / (SUBPIXELS * SUBPIXELS);
+            auto plane = [&](double* p, double f0, double f1, double f2) {
+                double dx = ((f1 - f0) * (ys[2] - ys[0]) - (f2 - f0) * (ys[1] - ys[0])) / determinant;
+                double dy = ((f2 - f0) * (xs[1] - xs[0]) - (f1 - f0) * (xs[2] - xs[0])) / determinant;
+                p[0] = f0 + dx * (0.5 - xs[0]) + dy * (0.5 - ys[0]);
+                p[1] = dx;
+                p[2] = dy;
+            };
+            plane(t.planes[0], depth[0], depth[1], depth[2]);
+            plane(t.planes[1], invW[0], invW[1], invW[2]);
+            for (int i = 0; i < r.varyingCount; i++)
+                plane(t.planes[2 + i], v[0]->varyings[i] * invW[0], v[1]->varyings[i] * invW[1], v[2]->varyings[i] * invW[2]);
+            t.minDepth = std::min({ depth[0], depth[1], depth[2] });
+            t.draw = draw;
+
+            uint32_t index = (uint32_t)triangles.size();
+            bool binned = false;
+            for (int ty = t.minY / TILE_SIZE; ty <= t.maxY / TILE_SIZE; ty++) {
+                for (int tx = t.minX / TILE_SIZE; tx <= t.maxX / TILE_SIZE; tx++) {
+                    int x0 = std::max(t.minX, tx * TILE_SIZE), x1 = std::min(t.maxX, tx * TILE_SIZE + TILE_SIZE - 1);
+                    int y0 = std::max(t.minY, ty * TILE_SIZE), y1 = std::min(t.maxY, ty * TILE_SIZE + TILE_SIZE - 1);
+                    if (!overlaps(t, x0, y0, x1, y1)) continue;
+                    bins[ty * r.tilesX + tx].push_back(index);
+                    stats.binEntries++;
+                    binned = true;
+                }
+            }
+            if (binned) {
+                triangles.push_back(t);
+                stats.setUp++;
+            }
+        }
+    };
+
+    void resize(int w, int h) {
+        width = w;
+        height = h;
+        pitch = (w + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+        blocksX = pitch / BLOCK_SIZE;
+        blocksY = (h + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        tilesX = (w + TILE_SIZE - 1) / TILE_SIZE;
+        tilesY = (h + TILE_SIZE - 1) / TILE_SIZE;
+        // Rows are padded to whole blocks, so SSE loads never leave the buffers
+        color.assign((size_t)pitch * blocksY * BLOCK_SIZE, 0xff000000u);
+        depth.assign((size_t)pitch * blocksY * BLOCK_SIZE, 1.0f);
+        blockDepth.assign((size_t)blocksX * blocksY, 1.0f);
+        setViewport(0, 0, w, h);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Viewport and scissor rectangle together, as glViewport + glScissor in the apps
+    void setViewport(int x, int y, int w, int h) {
+        viewportX = std::max(0, x);
+        viewportY = std::max(0, y);
+        viewportWidth = std::min(x + w, width) - viewportX;
+        viewportHeight = std::min(y + h, height) - viewportY;
+        guardX = 1.0f + 2.0f * GUARD_BAND / std::max(1, w);
+        guardY = 1.0f + 2.0f * GUARD_BAND / std::max(1, h);
+    }
+
+    // How many of Vertex::varyings the fragment function reads
+    void setVaryingCount(int count) { varyingCount = std::clamp(count, 0, MAX_VARYINGS); }
+
+    // Color and depth inside the viewport
+    void clear(const glm::vec3& clearColor) {
+        uint32_t packed = pack(clearColor);
+        for (int y = viewportY; y < viewportY + viewportHeight; y++)
+            std::fill_n(&color[(size_t)y * pitch + viewportX], viewportWidth, packed);
+        clearDepth();
+    }
+
+    // Depth inside the viewport
+    void clearDepth() {
+        for (int y = viewportY; y < viewportY + viewportHeight; y++)
+            std::fill_n(&depth[(size_t)y * pitch + viewportX], viewportWidth, 1.0f);
+        for (int by = viewportY / BLOCK_SIZE; by <= (viewportY + viewportHeight - 1) / BLOCK_SIZE; by++)
+            for (int bx = viewportX / BLOCK_SIZE; bx <= (viewportX + viewportWidth - 1) / BLOCK_SIZE; bx++)
+                updateBlockDepth(bx, by);
+    }
+
+    // Draw 'drawCount' draws. geometry(draw, Batch&) emits the triangles of
+    // one draw; fragment(draw, varyings) returns a fragment's color.
+    template <typename Geometry, typename Fragment>
+    void draw(size_t drawCount, const Geometry& geometry, const Fragment& fragment) {
+        if (drawCount == 0 || viewportWidth <= 0 || viewportHeight <= 0) return;
+        JobSystem& jobs = JobSystem::get();
+
+        size_t batchCount = std::min(drawCount, (size_t)BATCHES_PER_THREAD * (jobs.workerCount() + 1));
+        if (batches.size() < batchCount) batches.resize(batchCount);
+        for (size_t i = 0; i < batchCount; i++) batches[i].reset(this);
+        jobs.parallelFor(0, batchCount, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                PROFILE_ZONE("raster geometry");
+                size_t first = drawCount * i / batchCount, last = drawCount * (i + 1) / batchCount;
+                for (size_t d = first; d < last; d++) geometry(d, batches[i]);
+            }
+        });
+
+        // Tiles overlapping the viewport
+        int tx0 = viewportX / TILE_SIZE, tx1 = (viewportX + viewportWidth - 1) / TILE_SIZE;
+        int ty0 = viewportY / TILE_SIZE, ty1 = (viewportY + viewportHeight - 1) / TILE_SIZE;
+        int columns = tx1 - tx0 + 1;
+        size_t tiles = (size_t)columns * (ty1 - ty0 + 1);
+        tileStats.assign(tiles, Stats());
+        jobs.parallelFor(0, tiles, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                PROFILE_ZONE("raster tile");
+                int tx = tx0 + (int)(i % columns), ty = ty0 + (int)(i / columns);
+                rasterTile(tx, ty, batchCount, fragment, tileStats[i]);
+            }
+        });
+
+        for (size_t i = 0; i < batchCount; i++) totals.add(batches[i].stats);
+        for (const Stats& stats : tileStats) totals.add(stats);
+    }
+
+    // Counters since the last resetStats()
+    const Stats& stats() const { return totals; }
+    void resetStats() { totals = Stats(); }
+
+    // RGB of pixel (x, y), origin bottom-left
+    glm::u8vec3 pixel(int x, int y) const {
+        uint32_t c = color[(size_t)y * pitch + x];
+        return glm::u8vec3(c & 0xff, (c >> 8) & 0xff, (c >> 16) & 0xff);
+    }
+
+    // Binary PPM, top row first (the same layout HeadlessTarget writes)
+    bool writeImage(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+        file << "P6\n" << width << " " << height << "\n255\n";
+        std::vector<unsigned char> row((size_t)width * 3);
+        for (int y = height - 1; y >= 0; y--) {
+            for (int x = 0; x < width; x++) {
+                glm::u8vec3 rgb = pixel(x, y);
+                row[x * 3 + 0] = rgb.r;
+                row[x * 3 + 1] = rgb.g;
+                row[x * 3 + 2] = rgb.b;
+            }
+            file.write((const char*)row.data(), (std::streamsize)row.size());
+        }
+        return true;
+    }
+
+private:
+    int width = 0, height = 0, pitch = 0;
+    int blocksX = 0, blocksY = 0, tilesX = 0, tilesY = 0;
+    int viewportX = 0, viewportY = 0, viewportWidth = 0, viewportHeight = 0;
+    float guardX = 1.0f, guardY = 1.0f;
+    int varyingCount = 0;
+
+    std::vector<uint32_t> color;      // RGBA8, bottom row first
+    std::vector<float> depth;
+    std::vector<float> blockDepth;    // farthest depth in each block
+    std::vector<Batch> batches;
+    std::vector<Stats> tileStats;
+    Stats totals;
+
+    size_t tileCount() const { return (size_t)tilesX * tilesY; }
+
+    // GL's float to unsigned normalized conversion
+    static uint32_t pack(const glm::vec3& c) {
+        glm::vec3 v = glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f;
+        return (uint32_t)v.r | ((uint32_t)v.g << 8) | ((uint32_t)v.b << 16) | 0xff000000u;
+    }
+
+    // False when one edge is negative at every pixel centre of the rectangle
+    static bool overlaps(const Triangle& t, int x0, int y0, int x1, int y1) {
+        for (int i = 0; i < 3; i++) {
+            int64_t e = edgeAt(t, i, x0, y0);
+            e += std::max<int64_t>(0, (int64_t)t.a[i] * (x1 - x0) * SUBPIXELS);
+            e += std::max<int64_t>(0, (int64_t)t.b[i] * (y1 - y0) * SUBPIXELS);
+            if (e < 0) return false;
+        }
+        return true;
+    }
+
+    static int64_t edgeAt(const Triangle& t, int i, int x, int y) {
+        return (int64_t)t.a[i] * (x * SUBPIXELS + SUBPIXELS / 2) + (int64_t)t.b[i] * (y * SUBPIXELS + SUBPIXELS / 2) + t.c[i];
+    }
+
+    void updateBlockDepth(int bx, int by) {
+        float farthest = 0.0f;
+        for (int y = 0; y < BLOCK_SIZE; y++) {
+            const float* row = &depth[(size_t)(by * BLOCK_SIZE + y) * pitch + bx * BLOCK_SIZE];
+            for (int x = 0; x < BLOCK_SIZE; x++) farthest = std::max(farthest, row[x]);
+        }
+        blockDepth[(size_t)by * blocksX + bx] = farthest;
+    }
+
+    template <typename Fragment>
+    void rasterTile(int tx, int ty, size_t batchCount, const Fragment& fragment, Stats& stats) {
+        int x0 = std::max(viewportX, tx * TILE_SIZE), x1 = std::min(viewportX + viewportWidth, tx * TILE_SIZE + TILE_SIZE) - 1;
+        int y0 = std::max(viewportY, ty * TILE_SIZE), y1 = std::min(viewportY + viewportHeight, ty * TILE_SIZE + TILE_SIZE) - 1;
+        size_t tile = (size_t)ty * tilesX + tx;
+        for (size_t b = 0; b < batchCount; b++) {
+            const Batch& batch = batches[b];
+            for (uint32_t index : batch.bins[tile]) {
+                const Triangle& t = batch.triangles[index];
+                rasterTriangle(t, std::max(x0, t.minX), std::max(y0, t.minY), std::min(x1, t.maxX), std::min(y1, t.maxY),
+                    fragment, stats);
+            }
+        }
+    }
+
+    // The triangle's pixels inside [x0, x1] x [y0, y1], one block at a time
+    template <typename Fragment>
+    void rasterTriangle(const Triangle& t, int x0, int y0, int x1, int y1, const Fragment& fragment, Stats& stats) {
+        for (int by = y0 / BLOCK_SIZE; by <= y1 / BLOCK_SIZE; by++) {
+            for (int bx = x0 / BLOCK_SIZE; bx <= x1 / BLOCK_SIZE; bx++) {
+                if (t.minDepth >= blockDepth[(size_t)by * blocksX + bx]) {
+                    stats.blocksSkipped++;
+                    continue;
+                }
+                int left = bx * BLOCK_SIZE, bottom = by * BLOCK_SIZE;
+                if (!overlaps(t, left, bottom, left + BLOCK_SIZE - 1, bottom + BLOCK_SIZE - 1)) continue;
+                if (rasterBlock(t, bx, by, std::max(x0, left) - left, std::min(x1, left + BLOCK_SIZE - 1) - left,
+                    std::max(y0, bottom) - bottom, std::min(y1, bottom + BLOCK_SIZE - 1) - bottom, fragment, stats))
+                    updateBlockDepth(bx, by);
+            }
+        }
+    }
+
+    // Columns [c0, c1] of rows [r0, r1] of one block; true if any depth was written
+    template <typename Fragment>
+    bool rasterBlock(const Triangle& t, int bx, int by, int c0, int c1, int r0, int r1, const Fragment& fragment, Stats& stats) {
+        int left = bx * BLOCK_SIZE, bottom = by * BLOCK_SIZE;
+
+        // Edges at the block's first pixel. Inside the block an edge changes by
+        // less than 2^26, so saturating keeps every sign right in 32 bits.
+        int32_t edge[3], stepX[3], stepY[3];
+        for (int i = 0; i < 3; i++) {
+            edge[i] = (int32_t)std::clamp<int64_t>(edgeAt(t, i, left, bottom), -(1 << 29), 1 << 29);
+            stepX[i] = t.a[i] * SUBPIXELS;
+            stepY[i] = t.b[i] * SUBPIXELS;
+        }
+#ifdef SOFTWARE_RASTERIZER_SSE2
+        __m128i laneEdge[3];
+        for (int i = 0; i < 3; i++)
+            laneEdge[i] = _mm_setr_epi32(0, stepX[i], 2 * stepX[i], 3 * stepX[i]);
+#endif
+
+        // Planes at the block's first pixel, stepped in float inside it
+        int planeCount = 2 + varyingCount;
+        float base[2 + MAX_VARYINGS], dx[2 + MAX_VARYINGS], dy[2 + MAX_VARYINGS];
+        for (int p = 0; p < planeCount; p++) {
+            base[p] = (float)(t.planes[p][0] + t.planes[p][1] * left + t.planes[p][2] * bottom);
+            dx[p] = (float)t.planes[p][1];
+            dy[p] = (float)t.planes[p][2];
+        }
+
+        unsigned int columns = ((2u << c1) - 1) & ~((1u << c0) - 1);
+        bool written = false;
+        for (int row = r0; row <= r1; row++) {
+            float* depthRow = &depth[(size_t)(bottom + row) * pitch + left];
+            float rowDepth = base[0] + dy[0] * row;
+            float z[BLOCK_SIZE];
+            unsigned int mask = 0;
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+            __m128 laneDepth = _mm_mul_ps(_mm_set1_ps(dx[0]), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+            for (int half = 0; half < 2; half++) {
+                // A lane is outside when any edge is negative there
+                __m128i outside = _mm_setzero_si128();
+                for (int i = 0; i < 3; i++) {
+                    __m128i start = _mm_set1_epi32(edge[i] + stepY[i] * row + stepX[i] * 4 * half);
+                    outside = _mm_or_si128(outside, _mm_add_epi32(start, laneEdge[i]));
+                }
+                __m128 zq = _mm_add_ps(_mm_set1_ps(rowDepth + dx[0] * (float)(4 * half)), laneDepth);
+                _mm_storeu_ps(&z[4 * half], zq);
+                __m128 pass = _mm_cmplt_ps(zq, _mm_loadu_ps(&depthRow[4 * half]));
+                int covered = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & _mm_movemask_ps(pass) & 0xf;
+                mask |= (unsigned int)covered << (4 * half);
+            }
+#else
+            for (int column = 0; column < BLOCK_SIZE; column++) {
+                bool inside = true;
+                for (int i = 0; i < 3; i++)
+                    inside = inside && edge[i] + stepY[i] * row + stepX[i] * column >= 0;
+                z[column] = rowDepth + dx[0] * (float)(column & ~3) + dx[0] * (float)(column & 3);
+                if (inside && z[column] < depthRow[column]) mask |= 1u << column;
+            }
+#endif
+            mask &= columns;
+
+            for (; mask; mask &= mask - 1) {
+                int column = std::countr_zero(mask);
+                float invW = base[1] + dx[1] * column + dy[1] * row;
+                float w = 1.0f / invW;
+                float varyings[MAX_VARYINGS];
+                for (int i = 0; i < varyingCount; i++)
+                    varyings[i] = (base[2 + i] + dx[2 + i] * column + dy[2 + i] * row) * w;
+
+                glm::vec3 c = fragment(t.draw, (const float*)varyings);
+                color[(size_t)(bottom + row) * pitch + left + column] = pack(c);
+                depthRow[column] = z[column];
+                stats.fragments++;
+                written = true;
+            }
+        }
+        return written;
+    }
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
 #include "Cube.h"
+#include "SceneNode.h"
 
 class Table {
 public:
@@ -37,18 +38,15 @@ public:
         color = tableColor;
     }
 
-    // Draw the complete table with transformations
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz,
+    // Build the complete table under parent; returns its base node
+    SceneNode* build(SceneNode* parent, float tx, float ty, float tz,
         float rx = 0.0f, float ry = 0.0f, float rz = 0.0f) {
 
         // Create base transformation for the entire table
-        glm::mat4 tableBase = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        tableBase = glm::rotate(tableBase, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-        tableBase = glm::rotate(tableBase, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-        tableBase = glm::rotate(tableBase, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
+        SceneNode* tableBase = parent->addChild(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz));
 
         // Draw table top
-        cube.draw(shader, tableBase, 0.0f, legHeight, 0.0f,
+        tableBase->addPart(cube.getMesh(), 0.0f, legHeight, 0.0f,
             0.0f, 0.0f, 0.0f,
             topWidth, topHeight, topDepth, color);
 
@@ -56,30 +54,31 @@ public:
         float inset = 0.05f;
 
         // Front-left leg
-        cube.draw(shader, tableBase, inset, 0.0f, inset,
+        tableBase->addPart(cube.getMesh(), inset, 0.0f, inset,
             0.0f, 0.0f, 0.0f,
             legThickness, legHeight, legThickness, color);
 
         // Front-right leg
-        cube.draw(shader, tableBase, topWidth - inset - legThickness, 0.0f, inset,
+        tableBase->addPart(cube.getMesh(), topWidth - inset - legThickness, 0.0f, inset,
             0.0f, 0.0f, 0.0f,
             legThickness, legHeight, legThickness, color);
 
         // Back-left leg
-        cube.draw(shader, tableBase, inset, 0.0f, topDepth - inset - legThickness,
+        tableBase->addPart(cube.getMesh(), inset, 0.0f, topDepth - inset - legThickness,
             0.0f, 0.0f, 0.0f,
             legThickness, legHeight, legThickness, color);
 
         // Back-right leg
-        cube.draw(shader, tableBase, topWidth - inset - legThickness, 0.0f, topDepth - inset - legThickness,
+        tableBase->addPart(cube.getMesh(), topWidth - inset - legThickness, 0.0f, topDepth - inset - legThickness,
             0.0f, 0.0f, 0.0f,
             legThickness, legHeight, legThickness, color);
+
+        return tableBase;
     }
 
-    // Alternative draw method with separate position and rotation vectors
-    void draw(Shader& shader, glm::vec3 position, glm::vec3 rotation = glm::vec3(0.0f)) {
-        glm::mat4 identity = glm::mat4(1.0f);
-        draw(shader, identity, position.x, position.y, position.z,
+    // Alternative build method with separate position and rotation vectors
+    SceneNode* build(SceneNode* parent, glm::vec3 position, glm::vec3 rotation = glm::vec3(0.0f)) {
+        return build(parent, position.x, position.y, position.z,
             rotation.x, rotation.y, rotation.z);
     }
 };
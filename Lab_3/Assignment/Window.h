@@ -5,6 +5,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "shader.h"
 #include "Cube.h"
+#include "SceneNode.h"
 
 class Window {
 public:
@@ -40,42 +41,39 @@ public:
         glassColor = gColor;
     }
 
-    // Draw window with frame
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz,
+    // Build window with frame under parent; returns its base node
+    SceneNode* build(SceneNode* parent, float tx, float ty, float tz,
         float rotX = 0.0f, float rotY = 0.0f, float rotZ = 0.0f) {
 
-        glm::mat4 windowBase = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        windowBase = glm::rotate(windowBase, glm::radians(rotX), glm::vec3(1.0f, 0.0f, 0.0f));
-        windowBase = glm::rotate(windowBase, glm::radians(rotY), glm::vec3(0.0f, 1.0f, 0.0f));
-        windowBase = glm::rotate(windowBase, glm::radians(rotZ), glm::vec3(0.0f, 0.0f, 1.0f));
+        SceneNode* windowBase = parent->addChild(glm::vec3(tx, ty, tz), glm::vec3(rotX, rotY, rotZ));
 
         // Top frame
-        cube.draw(shader, windowBase, 0.0f, windowHeight, 0.0f,
+        windowBase->addPart(cube.getMesh(), 0.0f, windowHeight, 0.0f,
             0.0f, 0.0f, 0.0f,
             windowWidth, frameThickness, frameThickness, frameColor);
 
         // Bottom frame
-        cube.draw(shader, windowBase, 0.0f, 0.0f, 0.0f,
+        windowBase->addPart(cube.getMesh(), 0.0f, 0.0f, 0.0f,
             0.0f, 0.0f, 0.0f,
             windowWidth, frameThickness, frameThickness, frameColor);
 
         // Left frame
-        cube.draw(shader, windowBase, 0.0f, 0.0f, 0.0f,
+        windowBase->addPart(cube.getMesh(), 0.0f, 0.0f, 0.0f,
             0.0f, 0.0f, 0.0f,
             frameThickness, windowHeight + frameThickness, frameThickness, frameColor);
 
         // Right frame
-        cube.draw(shader, windowBase, windowWidth - frameThickness, 0.0f, 0.0f,
+        windowBase->addPart(cube.getMesh(), windowWidth - frameThickness, 0.0f, 0.0f,
             0.0f, 0.0f, 0.0f,
             frameThickness, windowHeight + frameThickness, frameThickness, frameColor);
 
         // Middle horizontal divider
-        cube.draw(shader, windowBase, 0.0f, windowHeight / 2.0f, 0.0f,
+        windowBase->addPart(cube.getMesh(), 0.0f, windowHeight / 2.0f, 0.0f,
             0.0f, 0.0f, 0.0f,
             windowWidth, frameThickness / 2.0f, frameThickness, frameColor);
 
         // Middle vertical divider
-        cube.draw(shader, windowBase, windowWidth / 2.0f - frameThickness / 4.0f, 0.0f, 0.0f,
+        windowBase->addPart(cube.getMesh(), windowWidth / 2.0f - frameThickness / 4.0f, 0.0f, 0.0f,
             0.0f, 0.0f, 0.0f,
             frameThickness / 2.0f, windowHeight + frameThickness, frameThickness, frameColor);
 
@@ -84,31 +82,32 @@ public:
         float paneHeight = (windowHeight - frameThickness / 2.0f) / 2.0f;
 
         // Top-left pane
-        cube.draw(shader, windowBase, frameThickness, windowHeight / 2.0f + frameThickness / 4.0f, -glassThickness / 2.0f,
+        windowBase->addPart(cube.getMesh(), frameThickness, windowHeight / 2.0f + frameThickness / 4.0f, -glassThickness / 2.0f,
             0.0f, 0.0f, 0.0f,
             paneWidth, paneHeight, glassThickness, glassColor);
 
         // Top-right pane
-        cube.draw(shader, windowBase, frameThickness + paneWidth + frameThickness / 2.0f, windowHeight / 2.0f + frameThickness / 4.0f, -glassThickness / 2.0f,
+        windowBase->addPart(cube.getMesh(), frameThickness + paneWidth + frameThickness / 2.0f, windowHeight / 2.0f + frameThickness / 4.0f, -glassThickness / 2.0f,
             0.0f, 0.0f, 0.0f,
             paneWidth, paneHeight, glassThickness, glassColor);
 
         // Bottom-left pane
-        cube.draw(shader, windowBase, frameThickness, frameThickness, -glassThickness / 2.0f,
+        windowBase->addPart(cube.getMesh(), frameThickness, frameThickness, -glassThickness / 2.0f,
             0.0f, 0.0f, 0.0f,
             paneWidth, paneHeight, glassThickness, glassColor);
 
         // Bottom-right pane
-        cube.draw(shader, windowBase, frameThickness + paneWidth + frameThickness / 2.0f, frameThickness, -glassThickness / 2.0f,
+        windowBase->addPart(cube.getMesh(), frameThickness + paneWidth + frameThickness / 2.0f, frameThickness, -glassThickness / 2.0f,
             0.0f, 0.0f, 0.0f,
             paneWidth, paneHeight, glassThickness, glassColor);
+
+        return windowBase;
     }
 
-    // Simplified draw with position vector
-    void draw(Shader& shader, glm::vec3 position,
+    // Simplified build with position vector
+    SceneNode* build(SceneNode* parent, glm::vec3 position,
         float rotX = 0.0f, float rotY = 0.0f, float rotZ = 0.0f) {
-        glm::mat4 identity = glm::mat4(1.0f);
-        draw(shader, identity, position.x, position.y, position.z, rotX, rotY, rotZ);
+        return build(parent, position.x, position.y, position.z, rotX, rotY, rotZ);
     }
 };
 
@@ -1,10 +1,18 @@
 #version 330 core
+// Feature permutation (see ShaderPermutations.h): the renderer compiles one program
+// per combination of DIRECTIONAL_LIGHT, POINT_LIGHTS, SPOT_LIGHT, AMBIENT, DIFFUSE,
+// and SPECULAR, defined in front of this source.
 out vec4 FragColor;
 in vec3 Normal;
 in vec3 FragPos;
+flat in vec3 matAmbient;
+flat in vec3 matDiffuse;
+flat in vec4 matSpecular;
 
-// Number of point lights
-#define NR_POINT_LIGHTS 4
+// Cluster grid dimensions (must match LightClusterGrid in ClusteredLights.h)
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
 
 struct Material {
     vec3 ambient;
@@ -44,71 +52,110 @@ struct SpotLight {
 
 // Uniforms
 uniform vec3 viewPos;
-uniform Material material;
-
-// Lights
-uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
-
-// Light toggles
-uniform bool directionalLightOn;
-uniform bool pointLightOn;
-uniform bool spotLightOn;
-
-// Component toggles
-uniform bool ambientOn;
-uniform bool diffuseOn;
-uniform bool specularOn;
-
-// Emissive
-uniform bool isEmissive;
-uniform vec3 emissiveColor;
+uniform mat4 view;
+
+// Point lights: four RGBA texels per light (position+k_c, ambient+k_l, diffuse+k_q, specular+radius)
+uniform samplerBuffer lightData;
+// Per-cluster (offset, count) into lightIndices
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer lightIndices;
+
+// Cluster lookup for the current viewport
+uniform bool useClusters;
+uniform vec4 viewportRect;      // x, y, width, height in window pixels
+uniform float clusterNear;
+uniform float clusterSliceScale; // CLUSTER_Z / log(far / near)
+
+// Lights, uploaded once per frame and shared by every viewport
+layout (std140) uniform LightBlock {
+    DirectionalLight directionalLight;
+    SpotLight spotLight;
+    int numPointLights;
+};
 
 // Function prototypes
 vec3 CalcDirectionalLight(Material mat, DirectionalLight light, vec3 N, vec3 V);
 vec3 CalcPointLight(Material mat, PointLight light, vec3 N, vec3 fragPos, vec3 V);
 vec3 CalcSpotLight(Material mat, SpotLight light, vec3 N, vec3 fragPos, vec3 V);
+PointLight FetchPointLight(int index);
+int ClusterIndex();
 
 void main()
 {
-    // Check if this is an emissive surface (like a light bulb)
-    if (isEmissive) {
-        FragColor = vec4(emissiveColor, 1.0);
-        return;
-    }
-
     // Properties
+    Material material = Material(matAmbient, matDiffuse, matSpecular.xyz, matSpecular.w);
     vec3 N = normalize(Normal);
     vec3 V = normalize(viewPos - FragPos);
 
     vec3 result = vec3(0.0);
 
     // Directional light
-    if (directionalLightOn) {
-        result += CalcDirectionalLight(material, directionalLight, N, V);
-    }
+#ifdef DIRECTIONAL_LIGHT
+    result += CalcDirectionalLight(material, directionalLight, N, V);
+#endif
 
     // Point lights
-    if (pointLightOn) {
-        for (int i = 0; i < NR_POINT_LIGHTS; i++) {
-            result += CalcPointLight(material, pointLights[i], N, FragPos, V);
+#ifdef POINT_LIGHTS
+    if (useClusters) {
+        // Only the lights binned into this fragment's cluster
+        uvec2 cluster = texelFetch(clusterGrid, ClusterIndex()).xy;
+        for (uint i = 0u; i < cluster.y; i++) {
+            int lightIndex = int(texelFetch(lightIndices, int(cluster.x + i)).x);
+            result += CalcPointLight(material, FetchPointLight(lightIndex), N, FragPos, V);
+        }
+    } else {
+        for (int i = 0; i < numPointLights; i++) {
+            result += CalcPointLight(material, FetchPointLight(i), N, FragPos, V);
         }
     }
+#endif
 
     // Spot light
-    if (spotLightOn) {
-        result += CalcSpotLight(material, spotLight, N, FragPos, V);
-    }
+#ifdef SPOT_LIGHT
+    result += CalcSpotLight(material, spotLight, N, FragPos, V);
+#endif
 
     // Ensure minimum visibility if all lights are off
-    if (!directionalLightOn && !pointLightOn && !spotLightOn) {
-        result = material.ambient * 0.1;
-    }
+#if !defined(DIRECTIONAL_LIGHT) && !defined(POINT_LIGHTS) && !defined(SPOT_LIGHT)
+    result = material.ambient * 0.1;
+#endif
 
     FragColor = vec4(result, 1.0);
 }
 
+// Reads point light 'index' from the light data buffer texture
+PointLight FetchPointLight(int index)
+{
+    vec4 t0 = texelFetch(lightData, index * 4 + 0);
+    vec4 t1 = texelFetch(lightData, index * 4 + 1);
+    vec4 t2 = texelFetch(lightData, index * 4 + 2);
+    vec4 t3 = texelFetch(lightData, index * 4 + 3);
+
+    PointLight light;
+    light.position = t0.xyz;
+    light.k_c = t0.w;
+    light.ambient = t1.xyz;
+    light.k_l = t1.w;
+    light.diffuse = t2.xyz;
+    light.k_q = t2.w;
+    light.specular = t3.xyz;
+    return light;
+}
+
+// Finds the froxel containing this fragment: screen tile from gl_FragCoord,
+// depth slice from the exponential split of the view-space distance
+int ClusterIndex()
+{
+    vec2 uv = (gl_FragCoord.xy - viewportRect.xy) / viewportRect.zw;
+    int x = clamp(int(uv.x * CLUSTER_X), 0, CLUSTER_X - 1);
+    int y = clamp(int(uv.y * CLUSTER_Y), 0, CLUSTER_Y - 1);
+
+    float depth = -(view * vec4(FragPos, 1.0)).z;
+    int z = clamp(int(floor(log(depth / clusterNear) * clusterSliceScale)), 0, CLUSTER_Z - 1);
+
+    return (z * CLUSTER_Y + y) * CLUSTER_X + x;
+}
+
 // Calculates directional light contribution
 vec3 CalcDirectionalLight(Material mat, DirectionalLight light, vec3 N, vec3 V)
 {
@@ -117,23 +164,23 @@ vec3 CalcDirectionalLight(Material mat, DirectionalLight light, vec3 N, vec3 V)
 
     // Ambient
     vec3 ambient = vec3(0.0);
-    if (ambientOn) {
-        ambient = mat.ambient * light.ambient;
-    }
+#ifdef AMBIENT
+    ambient = mat.ambient * light.ambient;
+#endif
 
     // Diffuse
     vec3 diffuse = vec3(0.0);
-    if (diffuseOn) {
-        float diff = max(dot(N, L), 0.0);
-        diffuse = mat.diffuse * diff * light.diffuse;
-    }
+#ifdef DIFFUSE
+    float diff = max(dot(N, L), 0.0);
+    diffuse = mat.diffuse * diff * light.diffuse;
+#endif
 
     // Specular
     vec3 specular = vec3(0.0);
-    if (specularOn) {
-        float spec = pow(max(dot(V, R), 0.0), mat.shininess);
-        specular = mat.specular * spec * light.specular;
-    }
+#ifdef SPECULAR
+    float spec = pow(max(dot(V, R), 0.0), mat.shininess);
+    specular = mat.specular * spec * light.specular;
+#endif
 
     return (ambient + diffuse + specular);
 }
@@ -150,23 +197,23 @@ vec3 CalcPointLight(Material mat, PointLight light, vec3 N, vec3 fragPos, vec3 V
 
     // Ambient
     vec3 ambient = vec3(0.0);
-    if (ambientOn) {
-        ambient = mat.ambient * light.ambient * attenuation;
-    }
+#ifdef AMBIENT
+    ambient = mat.ambient * light.ambient * attenuation;
+#endif
 
     // Diffuse
     vec3 diffuse = vec3(0.0);
-    if (diffuseOn) {
-        float diff = max(dot(N, L), 0.0);
-        diffuse = mat.diffuse * diff * light.diffuse * attenuation;
-    }
+#ifdef DIFFUSE
+    float diff = max(dot(N, L), 0.0);
+    diffuse = mat.diffuse * diff * light.diffuse * attenuation;
+#endif
 
     // Specular
     vec3 specular = vec3(0.0);
-    if (specularOn) {
-        float spec = pow(max(dot(V, R), 0.0), mat.shininess);
-        specular = mat.specular * spec * light.specular * attenuation;
-    }
+#ifdef SPECULAR
+    float spec = pow(max(dot(V, R), 0.0), mat.shininess);
+    specular = mat.specular * spec * light.specular * attenuation;
+#endif
 
     return (ambient + diffuse + specular);
 }
@@ -182,10 +229,11 @@ vec3 CalcSpotLight(Material mat, SpotLight light, vec3 N, vec3 fragPos, vec3 V)
     
     if (theta < light.cutOff) {
         // Outside spotlight cone - only ambient (dimmed)
-        if (ambientOn) {
-            return mat.ambient * light.ambient * 0.1;
-        }
+#ifdef AMBIENT
+        return mat.ambient * light.ambient * 0.1;
+#else
         return vec3(0.0);
+#endif
     }
 
     // Attenuation
@@ -198,23 +246,23 @@ vec3 CalcSpotLight(Material mat, SpotLight light, vec3 N, vec3 fragPos, vec3 V)
 
     // Ambient
     vec3 ambient = vec3(0.0);
-    if (ambientOn) {
-        ambient = mat.ambient * light.ambient * attenuation;
-    }
+#ifdef AMBIENT
+    ambient = mat.ambient * light.ambient * attenuation;
+#endif
 
     // Diffuse
     vec3 diffuse = vec3(0.0);
-    if (diffuseOn) {
-        float diff = max(dot(N, L), 0.0);
-        diffuse = mat.diffuse * diff * light.diffuse * attenuation * intensity;
-    }
+#ifdef DIFFUSE
+    float diff = max(dot(N, L), 0.0);
+    diffuse = mat.diffuse * diff * light.diffuse * attenuation * intensity;
+#endif
 
     // Specular
     vec3 specular = vec3(0.0);
-    if (specularOn) {
-        float spec = pow(max(dot(V, R), 0.0), mat.shininess);
-        specular = mat.specular * spec * light.specular * attenuation * intensity;
-    }
+#ifdef SPECULAR
+    float spec = pow(max(dot(V, R), 0.0), mat.shininess);
+    specular = mat.specular * spec * light.specular * attenuation * intensity;
+#endif
 
     return (ambient + diffuse + specular);
 }
@@ -1,21 +1,52 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec3 aPos;     // 16-bit normalized, in [-1, 1] over the mesh's box
+layout (location = 1) in vec2 aNormal;  // octahedral, see VertexCompression.h
+
+// Per-draw data from the render queue (see RenderQueue.h)
+layout (location = 2) in mat4 aModel;
+layout (location = 6) in vec3 aAmbient;
+layout (location = 7) in vec3 aDiffuse;
+layout (location = 8) in vec4 aSpecular;  // w = shininess
+layout (location = 9) in mat3 aNormalMatrix;  // inverse transpose of aModel, computed per draw on the CPU
+layout (location = 12) in vec3 aPositionScale;   // aPos back to object space
+layout (location = 13) in vec3 aPositionOffset;
 
 out vec3 FragPos;
 out vec3 Normal;
+flat out vec3 matAmbient;
+flat out vec3 matDiffuse;
+flat out vec4 matSpecular;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 position = aPositionOffset + aPositionScale * aPos;
+    vec3 normal = octDecode(aNormal);
+
+    gl_Position = projection * view * aModel * vec4(position, 1.0);
     
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    FragPos = vec3(aModel * vec4(position, 1.0));
 
     // Correct normal transformation using inverse-transpose to preserve perpendicularity
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+#ifdef PER_VERTEX_NORMAL_MATRIX
+    // The old per-vertex inverse, kept for --normal-benchmark
+    Normal = mat3(transpose(inverse(aModel))) * normal;
+#else
+    Normal = aNormalMatrix * normal;
+#endif
+
+    matAmbient = aAmbient;
+    matDiffuse = aDiffuse;
+    matSpecular = aSpecular;
     
 }
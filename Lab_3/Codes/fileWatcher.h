@@ -0,0 +1,136 @@
+//
+//  fileWatcher.h
+//  Reports files that were saved since the last check.
+//
+
+#ifndef fileWatcher_h
+#define fileWatcher_h
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// On Linux the directories of the watched files are registered with inotify, so
+// changed() is a single non-blocking read. Elsewhere (or when inotify is not
+// available) it compares modification times, at most every POLL_INTERVAL.
+class FileWatcher
+{
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{ 250 };
+
+    FileWatcher()
+    {
+#ifdef __linux__
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    ~FileWatcher()
+    {
+#ifdef __linux__
+        if (inotifyFd >= 0)
+            close(inotifyFd);
+#endif
+    }
+
+    void add(const std::string& path)
+    {
+        std::filesystem::path file(path);
+        WatchedFile watched;
+        watched.path = path;
+        watched.directory = file.has_parent_path() ? file.parent_path().string() : ".";
+        watched.name = file.filename().string();
+        watched.modified = modifiedTime(path);
+        files.push_back(watched);
+
+#ifdef __linux__
+        if (inotifyFd < 0)
+            return;
+        for (const auto& entry : directories)
+            if (entry.second == watched.directory)
+                return;
+        // Editors either rewrite the file in place or write a copy and rename it over
+        int wd = inotify_add_watch(inotifyFd, watched.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd >= 0)
+            directories[wd] = watched.directory;
+#endif
+    }
+
+    // Watched paths written since the last call, each listed once. Never blocks.
+    std::vector<std::string> changed()
+    {
+        std::vector<std::string> result;
+#ifdef __linux__
+        if (inotifyFd >= 0)
+        {
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+            {
+                for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + ((inotify_event*)p)->len)
+                {
+                    const inotify_event* event = (const inotify_event*)p;
+                    auto directory = directories.find(event->wd);
+                    if (event->len == 0 || directory == directories.end())
+                        continue;
+                    for (const WatchedFile& file : files)
+                        if (file.name == event->name && file.directory == directory->second)
+                            addOnce(result, file.path);
+                }
+            }
+            return result;
+        }
+#endif
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastPoll < POLL_INTERVAL)
+            return result;
+        lastPoll = now;
+        for (WatchedFile& file : files)
+        {
+            auto modified = modifiedTime(file.path);
+            if (modified != file.modified)
+            {
+                file.modified = modified;
+                addOnce(result, file.path);
+            }
+        }
+        return result;
+    }
+
+private:
+    struct WatchedFile
+    {
+        std::string path;
+        std::string directory;
+        std::string name;
+        std::filesystem::file_time_type modified;
+    };
+
+    std::vector<WatchedFile> files;
+    std::map<int, std::string> directories;   // inotify watch descriptor -> directory
+    int inotifyFd = -1;
+    std::chrono::steady_clock::time_point lastPoll;
+
+    static std::filesystem::file_time_type modifiedTime(const std::string& path)
+    {
+        std::error_code error;
+        return std::filesystem::last_write_time(path, error);
+    }
+
+    static void addOnce(std::vector<std::string>& paths, const std::string& path)
+    {
+        for (const std::string& existing : paths)
+            if (existing == path)
+                return;
+        paths.push_back(path);
+    }
+};
+
+#endif /* fileWatcher_h */
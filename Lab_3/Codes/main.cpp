@@ -16,6 +16,7 @@
 #include "basic_camera.h"
 #include "pointLight.h"
 #include "sphere.h"
+#include "shaderReloader.h"
 
 #include <iostream>
 
@@ -137,6 +138,11 @@ int main()
     //Shader lightingShader("vertexShaderForGouraudShading.vs", "fragmentShaderForGouraudShading.fs");
     Shader ourShader("vertexShader.vs", "fragmentShader.fs");
 
+    // rebuild the shaders in the background whenever their files are saved
+    ShaderReloader shaderReloader(window);
+    shaderReloader.watch(lightingShader, "vertexShaderForPhongShading.vs", "fragmentShaderForPhongShading.fs");
+    shaderReloader.watch(ourShader, "vertexShader.vs", "fragmentShader.fs");
+
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
 
@@ -248,6 +254,9 @@ int main()
         // -----
         processInput(window);
 
+        // swap in shaders that finished recompiling
+        shaderReloader.update();
+
         // render
         // ------
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
@@ -318,6 +327,7 @@ int main()
     glDeleteVertexArrays(1, &lightCubeVAO);
     glDeleteBuffers(1, &cubeVBO);
     glDeleteBuffers(1, &cubeEBO);
+    shaderReloader.shutdown();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
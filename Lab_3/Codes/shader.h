@@ -8,6 +8,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 class Shader
 {
@@ -95,6 +96,7 @@ public:
         if (geometryPath != nullptr)
             glDeleteShader(geometry);
 
+        cacheUniformLocations();
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -102,66 +104,211 @@ public:
     {
         glUseProgram(ID);
     }
+    // take over a program linked elsewhere (the shader reloader), dropping the old one
+    // ------------------------------------------------------------------------
+    void replaceProgram(unsigned int program)
+    {
+        glDeleteProgram(ID);
+        ID = program;
+        cacheUniformLocations();
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const
+    // Returns the cached location of a uniform (-1 if the program has none).
+    // Resolve once and pass the result to the set* overloads that take a location.
+    int uniform(const char* name) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        if (uniformSlots.empty())
+            return -1;
+        unsigned int hash = hashName(name);
+        size_t mask = uniformSlots.size() - 1;
+        for (size_t i = hash & mask; ; i = (i + 1) & mask)
+        {
+            const UniformSlot& slot = uniformSlots[i];
+            if (slot.location == EMPTY_SLOT)
+                return -1;
+            if (slot.hash == hash && slot.name == name)
+                return slot.location;
+        }
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
+    void setBool(int location, bool value) const
+    {
+        glUniform1i(location, (int)value);
+    }
+    void setBool(const char* name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setBool(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setInt(int location, int value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(location, value);
+    }
+    void setInt(const char* name, int value) const
+    {
+        setInt(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+    void setFloat(int location, float value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform1f(location, value);
     }
-    void setVec2(const std::string& name, float x, float y) const
+    void setFloat(const char* name, float value) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        setFloat(uniform(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void setVec2(int location, const glm::vec2& value) const
+    {
+        glUniform2fv(location, 1, &value[0]);
+    }
+    void setVec2(const char* name, const glm::vec2& value) const
+    {
+        setVec2(uniform(name), value);
+    }
+    void setVec2(int location, float x, float y) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2f(location, x, y);
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    void setVec2(const char* name, float x, float y) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        setVec2(uniform(name), x, y);
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void setVec3(int location, const glm::vec3& value) const
+    {
+        glUniform3fv(location, 1, &value[0]);
+    }
+    void setVec3(const char* name, const glm::vec3& value) const
+    {
+        setVec3(uniform(name), value);
+    }
+    void setVec3(int location, float x, float y, float z) const
+    {
+        glUniform3f(location, x, y, z);
+    }
+    void setVec3(const char* name, float x, float y, float z) const
+    {
+        setVec3(uniform(name), x, y, z);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(int location, const glm::vec4& value) const
+    {
+        glUniform4fv(location, 1, &value[0]);
+    }
+    void setVec4(const char* name, const glm::vec4& value) const
+    {
+        setVec4(uniform(name), value);
+    }
+    void setVec4(int location, float x, float y, float z, float w) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4f(location, x, y, z, w);
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w)
+    void setVec4(const char* name, float x, float y, float z, float w) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        setVec4(uniform(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void setMat2(int location, const glm::mat2& mat) const
+    {
+        glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat2(const char* name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(uniform(name), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void setMat3(int location, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat3(const char* name, const glm::mat3& mat) const
+    {
+        setMat3(uniform(name), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat4(int location, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void setMat4(const char* name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(uniform(name), mat);
     }
 
 private:
+    // Flat open-addressing table of active uniforms, built once after linking
+    struct UniformSlot
+    {
+        unsigned int hash;
+        int location;
+        std::string name;
+    };
+    static const int EMPTY_SLOT = -2;
+    std::vector<UniformSlot> uniformSlots;
+
+    // FNV-1a
+    static unsigned int hashName(const char* name)
+    {
+        unsigned int hash = 2166136261u;
+        for (; *name; ++name)
+            hash = (hash ^ (unsigned char)*name) * 16777619u;
+        return hash;
+    }
+
+    void insertUniform(const std::string& name, int location)
+    {
+        unsigned int hash = hashName(name.c_str());
+        size_t mask = uniformSlots.size() - 1;
+        size_t i = hash & mask;
+        while (uniformSlots[i].location != EMPTY_SLOT)
+            i = (i + 1) & mask;
+        uniformSlots[i] = { hash, location, name };
+    }
+
+    // Enumerate every active uniform once so the setters never query the driver
+    void cacheUniformLocations()
+    {
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::vector<std::pair<std::string, int>> found;
+        std::vector<char> buffer(maxLength + 1);
+        for (int i = 0; i < count; i++)
+        {
+            int size = 0;
+            unsigned int type = 0;
+            glGetActiveUniform(ID, i, (int)buffer.size(), nullptr, &size, &type, buffer.data());
+            std::string name = buffer.data();
+            int location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0)
+                continue; // member of a uniform block
+            found.push_back({ name, location });
+
+            // arrays are reported as "name[0]"; also register "name" and "name[i]"
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                std::string base = name.substr(0, name.size() - 3);
+                found.push_back({ base, location });
+                for (int e = 1; e < size; e++)
+                {
+                    std::string element = base + "[" + std::to_string(e) + "]";
+                    found.push_back({ element, glGetUniformLocation(ID, element.c_str()) });
+                }
+            }
+        }
+
+        // keep the load factor at or below one half
+        size_t capacity = 16;
+        while (capacity < found.size() * 2)
+            capacity *= 2;
+        uniformSlots.assign(capacity, { 0, EMPTY_SLOT, std::string() });
+        for (const auto& entry : found)
+            insertUniform(entry.first, entry.second);
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
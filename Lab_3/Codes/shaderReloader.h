@@ -0,0 +1,336 @@
+//
+//  shaderReloader.h
+//  Recompiles shaders in the background when their source files are saved.
+//
+
+#ifndef shaderReloader_h
+#define shaderReloader_h
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shader.h"
+#include "fileWatcher.h"
+
+// Call update() once per frame. When a watched file changes, every program
+// built from it is rebuilt on a worker thread that owns a hidden context
+// sharing objects with the window's context. A rebuilt program replaces
+// Shader::ID between frames, only after it linked and its fence signalled, so
+// the frame never waits on the compiler and a broken edit keeps the old
+// program on screen. With GL_KHR_parallel_shader_compile the driver compiles
+// all programs of a batch at once. Without a shared context, programs are
+// rebuilt on the main thread instead (still only swapped in on success).
+class ShaderReloader
+{
+public:
+    ShaderReloader(GLFWwindow* window)
+    {
+        detectParallelCompile();
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        compileWindow = glfwCreateWindow(1, 1, "shader compiler", NULL, window);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+        if (compileWindow)
+            worker = std::thread(&ShaderReloader::run, this);
+        else
+            std::cout << "Shader reload: no shared context, rebuilding on the main thread" << std::endl;
+    }
+
+    ~ShaderReloader()
+    {
+        shutdown();
+    }
+
+    // Rebuild 'shader' from these files whenever one of them is saved
+    void watch(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        programs.push_back({ &shader, vertexPath, fragmentPath });
+        watcher.add(vertexPath);
+        watcher.add(fragmentPath);
+    }
+
+    // Start rebuilds for changed files and swap in the programs that are ready
+    void update()
+    {
+        std::vector<Build> builds;
+        for (const std::string& path : watcher.changed())
+        {
+            for (const WatchedProgram& watched : programs)
+            {
+                if (watched.vertexPath != path && watched.fragmentPath != path)
+                    continue;
+                bool queued = false;
+                for (const Build& build : builds)
+                    queued = queued || build.shader == watched.shader;
+                if (!queued)
+                    builds.push_back({ watched.shader, watched.vertexPath, watched.fragmentPath });
+            }
+        }
+
+        if (!builds.empty())
+        {
+            if (worker.joinable())
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending.insert(pending.end(), builds.begin(), builds.end());
+                wake.notify_one();
+            }
+            else
+            {
+                buildBatch(builds);
+                for (Build& build : builds)
+                    apply(build);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < finished.size();)
+        {
+            Build& build = finished[i];
+            if (build.fence)
+            {
+                // Objects made by the other context are only safe to use once its commands completed
+                if (glClientWaitSync(build.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                {
+                    i++;
+                    continue;
+                }
+                glDeleteSync(build.fence);
+            }
+            apply(build);
+            finished.erase(finished.begin() + i);
+        }
+    }
+
+    // Stop the worker and release its context; call before glfwTerminate()
+    void shutdown()
+    {
+        if (worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            worker.join();
+        }
+        for (Build& build : finished)
+        {
+            if (build.fence) glDeleteSync(build.fence);
+            if (build.program) glDeleteProgram(build.program);
+        }
+        finished.clear();
+        if (compileWindow)
+        {
+            glfwDestroyWindow(compileWindow);
+            compileWindow = NULL;
+        }
+    }
+
+private:
+    static const unsigned int GL_COMPLETION_STATUS = 0x91B1;   // same value for the KHR and ARB extensions
+    typedef void (APIENTRY* MaxShaderCompilerThreadsProc)(GLuint count);
+
+    struct WatchedProgram
+    {
+        Shader* shader;
+        std::string vertexPath;
+        std::string fragmentPath;
+    };
+
+    struct Build
+    {
+        Shader* shader;
+        std::string vertexPath;
+        std::string fragmentPath;
+        unsigned int vertex = 0, fragment = 0, program = 0;
+        std::string log;
+        GLsync fence = 0;
+        double milliseconds = 0.0;
+
+        Build(Shader* target, const std::string& vertexFile, const std::string& fragmentFile)
+            : shader(target), vertexPath(vertexFile), fragmentPath(fragmentFile)
+        {
+        }
+    };
+
+    std::vector<WatchedProgram> programs;
+    FileWatcher watcher;
+    GLFWwindow* compileWindow = NULL;
+    MaxShaderCompilerThreadsProc maxShaderCompilerThreads = NULL;
+    bool parallelCompile = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Build> pending;    // waiting for the worker
+    std::vector<Build> finished;   // built by the worker, not yet swapped in
+    bool stopping = false;
+
+    void detectParallelCompile()
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+                maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+            else if (strcmp(name, "GL_ARB_parallel_shader_compile") == 0 && !maxShaderCompilerThreads)
+                maxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+        }
+        parallelCompile = maxShaderCompilerThreads != NULL;
+    }
+
+    void run()
+    {
+        glfwMakeContextCurrent(compileWindow);
+        if (parallelCompile)
+            maxShaderCompilerThreads(0xFFFFFFFF);   // as many as the driver likes
+
+        while (true)
+        {
+            std::vector<Build> builds;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (stopping)
+                    break;
+                builds.swap(pending);
+            }
+
+            buildBatch(builds);
+            for (Build& build : builds)
+            {
+                if (build.program)
+                    build.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+            glFlush();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.insert(finished.end(), builds.begin(), builds.end());
+        }
+        glfwMakeContextCurrent(NULL);
+    }
+
+    // Issue every compile and link first so a parallel compiler can overlap them,
+    // then collect the results
+    void buildBatch(std::vector<Build>& builds)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (Build& build : builds)
+            startBuild(build);
+        for (Build& build : builds)
+        {
+            finishBuild(build);
+            build.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    void startBuild(Build& build)
+    {
+        std::string vertexCode, fragmentCode;
+        if (!readFile(build.vertexPath, vertexCode) || !readFile(build.fragmentPath, fragmentCode))
+        {
+            build.log = "could not read the source files";
+            return;
+        }
+        build.vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+        build.fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+        build.program = glCreateProgram();
+        glAttachShader(build.program, build.vertex);
+        glAttachShader(build.program, build.fragment);
+        glLinkProgram(build.program);
+    }
+
+    void finishBuild(Build& build)
+    {
+        if (!build.program)
+            return;
+        if (parallelCompile)
+        {
+            GLint done = GL_FALSE;
+            while (glGetProgramiv(build.program, GL_COMPLETION_STATUS, &done), !done)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        GLint success = GL_FALSE;
+        char infoLog[1024];
+        glGetShaderiv(build.vertex, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(build.vertex, sizeof(infoLog), NULL, infoLog);
+            build.log += std::string("VERTEX:\n") + infoLog;
+        }
+        glGetShaderiv(build.fragment, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(build.fragment, sizeof(infoLog), NULL, infoLog);
+            build.log += std::string("FRAGMENT:\n") + infoLog;
+        }
+        glGetProgramiv(build.program, GL_LINK_STATUS, &success);
+        if (!success && build.log.empty())
+        {
+            glGetProgramInfoLog(build.program, sizeof(infoLog), NULL, infoLog);
+            build.log = std::string("PROGRAM:\n") + infoLog;
+        }
+
+        glDeleteShader(build.vertex);
+        glDeleteShader(build.fragment);
+        if (!success)
+        {
+            glDeleteProgram(build.program);
+            build.program = 0;
+        }
+    }
+
+    // Main thread only: swap the new program in, or report why there is none
+    void apply(Build& build)
+    {
+        std::string name = build.vertexPath + " + " + build.fragmentPath;
+        if (!build.program)
+        {
+            std::cout << "ERROR::SHADER_RELOAD: " << name << ", keeping the previous program\n"
+                << build.log << "\n -- --------------------------------------------------- -- " << std::endl;
+            return;
+        }
+        build.shader->replaceProgram(build.program);
+        build.program = 0;
+        std::cout << "Reloaded " << name << " in " << build.milliseconds << " ms"
+            << (parallelCompile ? " (parallel compile)" : "") << std::endl;
+    }
+
+    static unsigned int compileStage(GLenum type, const std::string& code)
+    {
+        const char* source = code.c_str();
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    static bool readFile(const std::string& path, std::string& contents)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        std::stringstream stream;
+        stream << file.rdbuf();
+        contents = stream.str();
+        return true;
+    }
+};
+
+#endif /* shaderReloader_h */
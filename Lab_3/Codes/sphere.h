@@ -9,11 +9,14 @@
 #define sphere_h
 
 #include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "shader.h"
+#include "VertexCompression.h"
 
 # define PI 3.1416
 
@@ -22,6 +25,15 @@ using namespace std;
 const int MIN_SECTOR_COUNT = 3;
 const int MIN_STACK_COUNT = 2;
 
+// GPU vertex: the position as 16-bit normalized integers over the sphere's
+// box (w keeps it 4-byte aligned) and the normal as 8-bit normalized integers,
+// 12 bytes where the floats take 24. The normal keeps three components, not
+// the arena's octahedral two, because the cubes share these shaders with float normals.
+struct SphereVertex {
+    int16_t position[4];
+    int8_t normal[4];
+};
+
 class Sphere
 {
 public:
@@ -35,6 +47,7 @@ public:
         set(radius, sectorCount, stackCount, amb, diff, spec, shiny);
         buildCoordinatesAndIndices();
         buildVertices();
+        buildPackedVertices();
 
         glGenVertexArrays(1, &sphereVAO);
         glBindVertexArray(sphereVAO);
@@ -44,8 +57,8 @@ public:
         glGenBuffers(1, &sphereVBO);
         glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);           // for vertex data
         glBufferData(GL_ARRAY_BUFFER,                   // target
-            this->getVertexSize(), // data size, # of bytes
-            this->getVertices(),   // ptr to vertex data
+            packedVertices.size() * sizeof(SphereVertex), // data size, # of bytes
+            packedVertices.data(), // ptr to vertex data
             GL_STATIC_DRAW);                   // usage
 
         // create EBO to copy index data
@@ -61,10 +74,10 @@ public:
         glEnableVertexAttribArray(0);
         glEnableVertexAttribArray(1);
 
-        // set attrib arrays with stride and offset
-        int stride = this->getVerticesStride();     // should be 24 bytes
-        glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, (void*)0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, (void*)(sizeof(float) * 3));
+        // set attrib arrays with stride and offset; both unpack to [-1, 1]
+        int stride = sizeof(SphereVertex);          // 12 bytes
+        glVertexAttribPointer(0, 3, GL_SHORT, true, stride, (void*)offsetof(SphereVertex, position));
+        glVertexAttribPointer(1, 3, GL_BYTE, true, stride, (void*)offsetof(SphereVertex, normal));
 
         // unbind VAO and VBOs
         glBindVertexArray(0);
@@ -154,7 +167,8 @@ public:
         lightingShader.setVec3("material.specular", this->specular);
         lightingShader.setFloat("material.shininess", this->shininess);
 
-        lightingShader.setMat4("model", model);
+        // the packed positions are scaled back to the sphere by the model matrix
+        lightingShader.setMat4("model", glm::scale(glm::translate(model, decode.offset), decode.scale));
 
         // draw a sphere with VAO
         glBindVertexArray(sphereVAO);
@@ -269,6 +283,22 @@ private:
         }
     }
 
+    // One scale on every axis, so the inverse transpose of the model matrix in
+    // the vertex shaders only changes the normals' length, which they normalize away
+    void buildPackedVertices()
+    {
+        decode.scale = glm::vec3(radius);
+        decode.offset = glm::vec3(0.0f);
+        for (size_t i = 0; i < coordinates.size(); i += 3)
+        {
+            SphereVertex vertex = {};
+            VertexCompression::packPosition(glm::vec3(coordinates[i], coordinates[i + 1], coordinates[i + 2]), decode, vertex.position);
+            for (int axis = 0; axis < 3; ++axis)
+                vertex.normal[axis] = VertexCompression::toSnorm8(normals[i + axis]);
+            packedVertices.push_back(vertex);
+        }
+    }
+
     vector<float> computeFaceNormal(float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3)
     {
         const float EPSILON = 0.000001f;
@@ -312,6 +342,8 @@ private:
     vector<float> normals;
     vector<unsigned int> indices;
     vector<float> coordinates;
+    vector<SphereVertex> packedVertices;    // what the VBO holds
+    VertexCompression::Decode decode;       // packed positions back to the sphere
     int verticesStride;                 // # of bytes to hop to the next vertex (should be 24 bytes)
 
 };
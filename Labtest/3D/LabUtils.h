@@ -4,22 +4,26 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include "Headless.h"
 
 // Standard resize callback
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
 
-// Consolidates all "Boilerplate" into one function
-GLFWwindow* setupWindow(int width, int height, const char* title) {
+// Consolidates all "Boilerplate" into one function.
+// A headless window is invisible and has no default framebuffer; render into a HeadlessTarget.
+GLFWwindow* setupWindow(int width, int height, const char* title, bool headless = false) {
     // 1. Init GLFW
+    if (headless) Headless::initHints();
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     // 2. Create Window
-    GLFWwindow* window = glfwCreateWindow(width, height, title, NULL, NULL);
+    GLFWwindow* window = headless ? Headless::createWindow(width, height, title)
+        : glfwCreateWindow(width, height, title, NULL, NULL);
     if (window == NULL) {
         std::cout << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
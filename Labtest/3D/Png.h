@@ -0,0 +1,218 @@
+#ifndef PNG_H
+#define PNG_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Only this file decodes images, so stb_image is built here: static, PNG only
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_NO_GIF   // STBI_ONLY_PNG alone still declares the static GIF loader
+#include <stb/stb_image.h>
+
+// 8-bit RGB PNG files, top row first. write() compresses with LZ77 and the
+// fixed Huffman codes of deflate, which is plenty for rendered frames with
+// large flat areas; read() takes any PNG and converts it to RGB.
+namespace Png {
+    namespace Detail {
+        inline uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+            static const std::vector<uint32_t> table = []() {
+                std::vector<uint32_t> t(256);
+                for (uint32_t n = 0; n < 256; n++) {
+                    uint32_t c = n;
+                    for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[n] = c;
+                }
+                return t;
+            }();
+            crc = ~crc;
+            for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        inline uint32_t adler32(const std::vector<unsigned char>& data) {
+            uint32_t a = 1, b = 0;
+            for (unsigned char byte : data) {
+                a = (a + byte) % 65521;
+                b = (b + a) % 65521;
+            }
+            return (b << 16) | a;
+        }
+
+        // Deflate emits bits least significant first; Huffman codes go most significant first
+        struct BitWriter {
+            std::vector<unsigned char> bytes;
+            uint32_t buffer = 0;
+            int count = 0;
+
+            void bits(uint32_t value, int n) {
+                buffer |= value << count;
+                count += n;
+                while (count >= 8) {
+                    bytes.push_back((unsigned char)buffer);
+                    buffer >>= 8;
+                    count -= 8;
+                }
+            }
+            void code(uint32_t value, int n) {
+                uint32_t reversed = 0;
+                for (int i = 0; i < n; i++) reversed |= ((value >> i) & 1) << (n - 1 - i);
+                bits(reversed, n);
+            }
+            void flush() {
+                if (count > 0) bytes.push_back((unsigned char)buffer);
+                buffer = 0;
+                count = 0;
+            }
+        };
+
+        inline void literal(BitWriter& out, int symbol) {
+            if (symbol < 144) out.code(0x30 + symbol, 8);
+            else if (symbol < 256) out.code(0x190 + symbol - 144, 9);
+            else if (symbol < 280) out.code(symbol - 256, 7);
+            else out.code(0xC0 + symbol - 280, 8);
+        }
+
+        inline void match(BitWriter& out, int length, int distance) {
+            static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+            static const int lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+            static const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+            static const int distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+            int l = 28;
+            while (lengthBase[l] > length) l--;
+            literal(out, 257 + l);
+            out.bits(length - lengthBase[l], lengthExtra[l]);
+
+            int d = 29;
+            while (distanceBase[d] > distance) d--;
+            out.code(d, 5);
+            out.bits(distance - distanceBase[d], distanceExtra[d]);
+        }
+
+        // One fixed-Huffman block; matches come from a hash of the next three
+        // bytes, keeping only the latest position per hash
+        inline std::vector<unsigned char> deflate(const std::vector<unsigned char>& data) {
+            const int WINDOW = 32768, MAX_MATCH = 258, HASH_SIZE = 1 << 15;
+            std::vector<int> head(HASH_SIZE, -1);
+            auto hash = [&](size_t i) {
+                return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (HASH_SIZE - 1);
+            };
+
+            BitWriter out;
+            out.bits(0x78, 8);   // zlib header: deflate, 32K window
+            out.bits(0x01, 8);
+            out.bits(1, 1);      // final block
+            out.bits(1, 2);      // fixed Huffman codes
+
+            size_t i = 0;
+            while (i < data.size()) {
+                int length = 0, distance = 0;
+                if (i + 3 <= data.size()) {
+                    int h = hash(i);
+                    int candidate = head[h];
+                    head[h] = (int)i;
+                    if (candidate >= 0 && (int)i - candidate <= WINDOW) {
+                        size_t limit = std::min<size_t>(MAX_MATCH, data.size() - i);
+                        while ((size_t)length < limit && data[candidate + length] == data[i + length]) length++;
+                        distance = (int)i - candidate;
+                    }
+                }
+                if (length >= 3) {
+                    match(out, length, distance);
+                    for (size_t k = i + 1; k < i + length && k + 3 <= data.size(); k++) head[hash(k)] = (int)k;
+                    i += length;
+                }
+                else {
+                    literal(out, data[i++]);
+                }
+            }
+            literal(out, 256);
+            out.flush();
+
+            uint32_t adler = adler32(data);
+            for (int shift = 24; shift >= 0; shift -= 8) out.bytes.push_back((unsigned char)(adler >> shift));
+            return out.bytes;
+        }
+
+        inline void chunk(std::ofstream& file, const char* type, const std::vector<unsigned char>& data) {
+            std::vector<unsigned char> body(type, type + 4);
+            body.insert(body.end(), data.begin(), data.end());
+            auto be32 = [&](uint32_t v) {
+                unsigned char b[4] = { (unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v };
+                file.write((const char*)b, 4);
+            };
+            be32((uint32_t)data.size());
+            file.write((const char*)body.data(), (std::streamsize)body.size());
+            be32(crc32(body.data(), body.size()));
+        }
+    }
+
+    // Each row gets whichever of the None, Sub and Up filters leaves the
+    // smallest residuals, the usual heuristic from the PNG specification
+    inline bool write(const std::string& path, const std::vector<unsigned char>& rgb, int width, int height) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        const size_t stride = (size_t)width * 3;
+        std::vector<unsigned char> filtered;
+        filtered.reserve((stride + 1) * height);
+        std::vector<unsigned char> candidates[3];
+        for (int y = 0; y < height; y++) {
+            const unsigned char* row = &rgb[y * stride];
+            const unsigned char* above = y > 0 ? row - stride : nullptr;
+            int best = 0;
+            long bestCost = -1;
+            for (int type = 0; type < 3; type++) {
+                std::vector<unsigned char>& c = candidates[type];
+                c.resize(stride);
+                long cost = 0;
+                for (size_t x = 0; x < stride; x++) {
+                    unsigned char predictor = 0;
+                    if (type == 1 && x >= 3) predictor = row[x - 3];
+                    if (type == 2 && above) predictor = above[x];
+                    c[x] = (unsigned char)(row[x] - predictor);
+                    cost += std::abs((int)(signed char)c[x]);
+                }
+                if (bestCost < 0 || cost < bestCost) {
+                    best = type;
+                    bestCost = cost;
+                }
+            }
+            filtered.push_back((unsigned char)best);
+            filtered.insert(filtered.end(), candidates[best].begin(), candidates[best].end());
+        }
+
+        static const unsigned char signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+        file.write((const char*)signature, 8);
+        std::vector<unsigned char> header = {
+            (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width,
+            (unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height,
+            8, 2, 0, 0, 0   // 8-bit RGB, no interlacing
+        };
+        Detail::chunk(file, "IHDR", header);
+        Detail::chunk(file, "IDAT", Detail::deflate(filtered));
+        Detail::chunk(file, "IEND", {});
+        return (bool)file;
+    }
+
+    inline bool read(const std::string& path, std::vector<unsigned char>& rgb, int& width, int& height) {
+        int channels = 0;
+        unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 3);
+        if (!pixels) return false;
+        rgb.assign(pixels, pixels + (size_t)width * height * 3);
+        stbi_image_free(pixels);
+        return true;
+    }
+}
+
+#endif
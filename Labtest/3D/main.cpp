@@ -4,6 +4,7 @@
 #include "Cylinder.h"     // The Cylinder
 #include "MyTransform.h"  // Your Custom Math
 #include <iostream>
+#include <cstring>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -87,18 +88,32 @@ void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) sc_D += speed;
 }
 
-int main() {
-    // 1. Setup
-    GLFWwindow* window = setupWindow(800, 600, "Lab Test: 12 Keys");
+int main(int argc, char** argv) {
+    // 1. Setup (--headless [frames] renders offscreen and writes timings and the last frame)
+    HeadlessOptions headless = HeadlessOptions::parse(argc, argv);
+    for (int i = 1; i < argc; i++) {
+        // Always compile shaders from source instead of using shader_cache/
+        if (strcmp(argv[i], "--no-shader-cache") == 0) ProgramCache::enabled() = false;
+    }
+    GLFWwindow* window = setupWindow(800, 600, "Lab Test: 12 Keys", headless.enabled);
     if (!window) return -1;
 
+    HeadlessTarget offscreen;
+    if (headless.enabled && !offscreen.create(800, 600)) {
+        std::cout << "Failed to create offscreen framebuffer" << std::endl;
+        return -1;
+    }
+    int frame = 0;
+
     printInstructions(); // Show keys in terminal
 
     Shader ourShader("vertex.vs", "fragment.fs");
+    ProgramCache::printSummary();
     Cube myCube; // We use one object definition to draw 4 times
 
     // 2. Loop
-    while (!glfwWindowShouldClose(window)) {
+    while (headless.enabled ? frame++ < headless.frames : !glfwWindowShouldClose(window)) {
+        if (headless.enabled) offscreen.beginFrame();
         processInput(window);
 
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
@@ -162,12 +177,20 @@ int main() {
         modelD = myScale(modelD, glm::vec3(sc_D));
         myCube.draw(ourShader.ID, modelD);
 
+        if (headless.enabled) offscreen.endFrame();
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    // With --golden or --perf-baseline a failed check fails the run
+    bool passed = true;
+    if (headless.enabled) {
+        passed = offscreen.finish(headless);
+        offscreen.destroy();
+    }
+
     myCube.cleanup();
     glfwTerminate();
-    return 0;
+    return passed ? 0 : 1;
 }
\ No newline at end of file
@@ -2,10 +2,11 @@
 #define COCKPIT_INTERIOR_H
 
 #include "Cube.h"
+#include "SceneNode.h"
 #include "Sphere.h"
 #include "Cylinder.h"
+#include "GpuTimer.h"
 #include <glm/glm.hpp>
-#include "Shader.h"
 
 class CockpitInterior {
 private:
@@ -18,21 +19,22 @@ private:
     const glm::vec3 SEAT_CUSHION = glm::vec3(0.25f, 0.22f, 0.2f);
     const glm::vec3 METAL_FRAME = glm::vec3(0.3f, 0.3f, 0.32f);
 
-public:
-    CockpitInterior() {}
+    // Part tree built once in the constructor
+    SceneNode root;
 
-    // Camera at (0,0,0) looking toward +X
-    void draw(Shader& shader, glm::mat4 parentModel) {
+public:
+    // Build the part tree once; every part is static relative to the root
+    CockpitInterior() {
 
         // ===== LEFT SEAT (pilot's view of co-pilot seat on left) =====
         // Seat back
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.8f, 0.0f, 0.4f,
             0.0f, 0.0f, 0.0f,
             0.08f, 0.5f, 0.4f,
             SEAT_BACK);
         // Headrest
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.8f, 0.35f, 0.4f,
             0.0f, 0.0f, 0.0f,
             0.06f, 0.15f, 0.2f,
@@ -40,13 +42,13 @@ public:
 
         // ===== RIGHT SEAT (pilot's view of another seat on right) =====
         // Seat back
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.8f, 0.0f, -0.4f,
             0.0f, 0.0f, 0.0f,
             0.08f, 0.5f, 0.4f,
             SEAT_BACK);
         // Headrest
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.8f, 0.35f, -0.4f,
             0.0f, 0.0f, 0.0f,
             0.06f, 0.15f, 0.2f,
@@ -54,35 +56,35 @@ public:
 
         // ===== FRONT WINDOW FRAME =====
         // Top horizontal bar
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             1.5f, 0.6f, 0.0f,
             0.0f, 0.0f, 0.0f,
             0.05f, 0.05f, 0.65f,
             METAL_FRAME);
 
         // Bottom horizontal bar
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             1.2f, -0.1f, 0.0f,
             0.0f, 0.0f, 0.0f,
             0.05f, 0.05f, 0.65f,
             METAL_FRAME);
 
         // Left front corner pillar (A-pillar)
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             1.35f, 0.25f, 0.6f,
             0.0f, 0.0f, -15.0f,
             0.05f, 0.5f, 0.05f,
             METAL_FRAME);
 
         // Right front corner pillar (A-pillar)
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             1.35f, 0.25f, -0.6f,
             0.0f, 0.0f, 15.0f,
             0.05f, 0.5f, 0.05f,
             METAL_FRAME);
 
         // Center vertical strut
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             1.35f, 0.25f, 0.0f,
             0.0f, 0.0f, 0.0f,
             0.03f, 0.45f, 0.03f,
@@ -90,19 +92,19 @@ public:
 
         // ===== LEFT SIDE WINDOW FRAME =====
         // Left side top bar (connects to A-pillar)
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.6f, 0.45f, 0.6f,
             0.0f, 0.0f, 0.0f,
             0.8f, 0.04f, 0.04f,
             METAL_FRAME);
         // Left side bottom bar
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.6f, -0.1f, 0.6f,
             0.0f, 0.0f, 0.0f,
             0.8f, 0.04f, 0.04f,
             METAL_FRAME);
         // Left side rear vertical (B-pillar)
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             -0.2f, 0.17f, 0.6f,
             0.0f, 0.0f, 0.0f,
             0.04f, 0.35f, 0.04f,
@@ -110,24 +112,47 @@ public:
 
         // ===== RIGHT SIDE WINDOW FRAME =====
         // Right side top bar (connects to A-pillar)
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.6f, 0.45f, -0.6f,
             0.0f, 0.0f, 0.0f,
             0.8f, 0.04f, 0.04f,
             METAL_FRAME);
         // Right side bottom bar
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             0.6f, -0.1f, -0.6f,
             0.0f, 0.0f, 0.0f,
             0.8f, 0.04f, 0.04f,
             METAL_FRAME);
         // Right side rear vertical (B-pillar)
-        cube.draw(shader, parentModel,
+        root.addPart(cube.getMesh(),
             -0.2f, 0.17f, -0.6f,
             0.0f, 0.0f, 0.0f,
             0.04f, 0.35f, 0.04f,
             METAL_FRAME);
     }
+
+    // Camera at (0,0,0) looking toward +X
+    void draw(glm::mat4 parentModel) {
+        PROFILE_ZONE("CockpitInterior::draw");
+        record(parentModel);
+        flush();
+    }
+
+    // Queue every part at parentModel. Part world matrices are cached, so they are
+    // only recomputed when parentModel differs from the previous call.
+    void record(glm::mat4 parentModel) {
+        root.setParentMatrix(parentModel);
+        root.visitDrawables([](SceneNode& node) {
+            node.mesh->add(node.getWorld(), node.color);
+        });
+    }
+
+    void flush() {
+        GPU_ZONE("CockpitInterior::flush");
+        cube.flush();
+        sphere.flush();
+        cylinder.flush();
+    }
 };
 
 #endif
@@ -6,43 +6,47 @@
 #include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include "Shader.h"
+#include "MeshCache.h"
+#include "TransformBatch.h"
 
 // Hexagonal prism - for futuristic tech panels and structures
 class Hexagon {
 public:
     Hexagon() {
-        setUpHexagon();
+        mesh = MeshCache::get().acquire(MeshKey(MESH_HEXAGON), buildHexagon);
     }
 
     ~Hexagon() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        MeshCache::get().release(mesh);
     }
 
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
-        glm::mat4 t = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        glm::mat4 rX = glm::rotate(t, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-        glm::mat4 rY = glm::rotate(rX, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-        glm::mat4 rZ = glm::rotate(rY, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::mat4 m = glm::scale(rZ, glm::vec3(sx, sy, sz));
+    // Draw with explicit transformations (single instance, drawn immediately)
+    void draw(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+        submit(parentModel, tx, ty, tz, rx, ry, rz, sx, sy, sz, colorVec);
+        flush();
+    }
+
+    // Queue one instance; nothing is drawn until flush()
+    void submit(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+        glm::mat4 m = parentModel * TransformBatch::composeTRS(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz), glm::vec3(sx, sy, sz));
 
-        shader.setMat4("model", m);
-        shader.setVec3("customColor", colorVec);
+        mesh->add(m, colorVec);
+    }
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    // Draw every queued instance with one instanced call
+    void flush() {
+        mesh->flush();
     }
 
+    // Shared mesh, for scene graph parts that queue their own instances
+    Mesh* getMesh() const { return mesh; }
+
 private:
-    unsigned int VAO, VBO, EBO;
-    int indexCount;
+    Mesh* mesh;
 
-    void setUpHexagon() {
-        std::vector<float> vertices;
-        std::vector<unsigned int> indices;
+    static void buildHexagon(MeshData& data) {
+        std::vector<float>& vertices = data.vertices;
+        std::vector<unsigned int>& indices = data.indices;
         
         const float PI = 3.14159265359f;
         const int sides = 6;
@@ -103,24 +107,6 @@ private:
             indices.push_back(bot2);
             indices.push_back(top2);
         }
-        
-        indexCount = indices.size();
-
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glBindVertexArray(0);
     }
 };
 
@@ -0,0 +1,60 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// Per-instance attributes read by vertexShader.vs
+// location 1-4 : model matrix (one vec4 column per location)
+// location 5   : color
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec3 color;
+};
+
+// Streams per-instance attributes for the mesh arena. The attributes point
+// at offset 0, so each instanced draw uploads its own instances first.
+class InstanceBuffer {
+public:
+    InstanceBuffer() : VBO(0) {}
+
+    ~InstanceBuffer() {
+        destroy();
+    }
+
+    // Hook the instance attributes into the bound VAO (call once)
+    void attach() {
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+        for (int i = 0; i < 4; i++) {
+            glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                (void*)(offsetof(InstanceData, model) + i * sizeof(glm::vec4)));
+            glEnableVertexAttribArray(1 + i);
+            glVertexAttribDivisor(1 + i, 1);
+        }
+
+        glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, color));
+        glEnableVertexAttribArray(5);
+        glVertexAttribDivisor(5, 1);
+    }
+
+    void upload(const std::vector<InstanceData>& instances) {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // Orphan the old storage so the driver does not wait on the previous draw
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    }
+
+    void destroy() {
+        if (VBO) glDeleteBuffers(1, &VBO);
+        VBO = 0;
+    }
+
+private:
+    unsigned int VBO;
+};
+
+#endif
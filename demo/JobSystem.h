@@ -0,0 +1,338 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Profiler.h"
+
+// Work-stealing task scheduler for per-frame CPU work:
+//
+//     JobSystem& jobs = JobSystem::get();
+//     jobs.parallelFor(0, objects.size(), 64, [&](size_t begin, size_t end) {
+//         for (size_t i = begin; i < end; i++) ...
+//     });
+//
+// Every thread that runs jobs owns a Chase-Lev deque: it pushes and pops jobs
+// at the bottom, idle threads steal from the top. A job's 'unfinished' counter
+// starts at 1 and is raised by each child created under it; a job only counts
+// as finished once it and all its children ran, so wait(parent) waits for a
+// whole tree. Threads waiting on a job run other jobs meanwhile.
+//
+// The pool has hardware_concurrency() - 1 worker threads by default; the
+// threads that submit jobs (main, update) take part too. With no workers, as on
+// a single core, parallelFor() simply runs the loop on the calling thread.
+class JobSystem {
+public:
+    struct Job {
+        static constexpr size_t PAYLOAD = 80;
+
+        void (*function)(Job&) = nullptr;
+        Job* parent = nullptr;
+        std::atomic<int> unfinished{ 0 };
+        alignas(std::max_align_t) unsigned char payload[PAYLOAD];
+    };
+
+    // Most threads outside the pool that may submit jobs (main, update, ...)
+    static constexpr int MAX_EXTERNAL_THREADS = 4;
+
+    static JobSystem& get() {
+        static JobSystem system(defaultWorkerCount());
+        return system;
+    }
+
+    static int defaultWorkerCount() {
+        return std::max(0, (int)std::thread::hardware_concurrency() - 1);
+    }
+
+    explicit JobSystem(int workers) {
+        for (int i = 0; i < MAX_EXTERNAL_THREADS; i++)
+            slots.push_back(std::make_unique<Slot>());
+        setWorkerCount(workers);
+    }
+
+    ~JobSystem() {
+        stopWorkers();
+    }
+
+    // Restart the pool with 'count' worker threads. No jobs may be in flight.
+    void setWorkerCount(int count) {
+        stopWorkers();
+        slots.resize(MAX_EXTERNAL_THREADS);
+        for (int i = 0; i < count; i++)
+            slots.push_back(std::make_unique<Slot>());
+        stopping = false;
+        for (int i = 0; i < count; i++)
+            workers.emplace_back(&JobSystem::workerLoop, this, MAX_EXTERNAL_THREADS + i);
+    }
+
+    int workerCount() const { return (int)workers.size(); }
+
+    // A job running work(), or work(job) to create children of itself. Work
+    // must be trivially copyable and fit the payload (a lambda capturing a few
+    // references or pointers). The job is counted as a child of 'parent'.
+    template <typename Work>
+    Job* create(Work work, Job* parent = nullptr) {
+        static_assert(sizeof(Work) <= Job::PAYLOAD, "job captures too much; capture a pointer to a struct");
+        static_assert(std::is_trivially_copyable_v<Work>, "job work must be trivially copyable");
+
+        Job* job = ownSlot().allocate();
+        job->function = [](Job& self) {
+            Work& stored = *std::launder(reinterpret_cast<Work*>(self.payload));
+            if constexpr (std::is_invocable_v<Work&, Job&>) stored(self);
+            else stored();
+        };
+        new (job->payload) Work(work);
+        job->parent = parent;
+        job->unfinished.store(1, std::memory_order_relaxed);
+        if (parent) parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+        return job;
+    }
+
+    // Queue a job on the calling thread's deque (runs it right away when the deque is full)
+    void run(Job* job) {
+        Slot& slot = ownSlot();
+        if (!slot.deque.push(job)) {
+            execute(job);
+            return;
+        }
+        queuedJobs.fetch_add(1);
+        if (sleepingWorkers.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    // Return once 'job' and all its children finished, running queued jobs meanwhile
+    void wait(const Job* job) {
+        while (job->unfinished.load(std::memory_order_acquire) > 0) {
+            if (Job* next = takeJob(ownSlotIndex()))
+                execute(next);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    // body(begin, end) over [begin, end) in pieces of at most 'grain' items.
+    // The range is halved recursively, so idle threads steal big pieces first.
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Body& body) {
+        if (end <= begin) return;
+        // Enough pieces to balance the threads, few enough to stay well inside the job pool
+        size_t maxPieces = 8 * (workers.size() + 1);
+        grain = std::max({ grain, (size_t)1, (end - begin + maxPieces - 1) / maxPieces });
+        if (workers.empty() || end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+
+        ForRange<Body> range = { this, &body, begin, end, grain };
+        Job* root = create([range](Job& self) { range.split(self); });
+        run(root);
+        wait(root);
+    }
+
+private:
+    // Chase-Lev deque (fixed capacity) with the C11 orderings of Le et al.,
+    // "Correct and Efficient Work-Stealing for Weak Memory Models" (2013)
+    class WorkStealingDeque {
+    public:
+        static constexpr long CAPACITY = 4096;
+
+        // Owner only
+        bool push(Job* job) {
+            long b = bottom.load(std::memory_order_relaxed);
+            long t = top.load(std::memory_order_acquire);
+            if (b - t >= CAPACITY) return false;
+            jobs[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Owner only; newest job first
+        Job* pop() {
+            long b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            long t = top.load(std::memory_order_relaxed);
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            Job* job = jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (t == b) {
+                // Last job: race the thieves for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    job = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        // Any thread; oldest job first
+        Job* steal() {
+            long t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            long b = bottom.load(std::memory_order_acquire);
+            if (t >= b) return nullptr;
+            Job* job = jobs[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return job;
+        }
+
+    private:
+        alignas(64) std::atomic<long> top{ 0 };
+        alignas(64) std::atomic<long> bottom{ 0 };
+        std::atomic<Job*> jobs[CAPACITY];
+    };
+
+    // A deque plus the ring its owner allocates jobs from. Jobs still running
+    // are skipped, so one thread may have up to POOL_SIZE jobs in flight.
+    struct Slot {
+        static constexpr size_t POOL_SIZE = 4096;
+
+        WorkStealingDeque deque;
+        std::unique_ptr<Job[]> pool{ new Job[POOL_SIZE] };
+        size_t allocated = 0;
+
+        Job* allocate() {
+            while (true) {
+                Job* job = &pool[allocated++ & (POOL_SIZE - 1)];
+                if (job->unfinished.load(std::memory_order_acquire) == 0) return job;
+            }
+        }
+    };
+
+    template <typename Body>
+    struct ForRange {
+        JobSystem* system;
+        const Body* body;
+        size_t begin, end, grain;
+
+        void split(Job& self) const {
+            if (end - begin <= grain) {
+                (*body)(begin, end);
+                return;
+            }
+            size_t middle = begin + (end - begin) / 2;
+            ForRange left = { system, body, begin, middle, grain };
+            ForRange right = { system, body, middle, end, grain };
+            system->run(system->create([right](Job& child) { right.split(child); }, &self));
+            left.split(self);
+        }
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;   // MAX_EXTERNAL_THREADS external slots, then one per worker
+    std::vector<std::thread> workers;
+    std::atomic<int> queuedJobs{ 0 };
+    std::atomic<int> sleepingWorkers{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    std::mutex externalMutex;
+    std::vector<std::thread::id> externalThreads;
+
+    // Each system gets an id so a thread's cached slot never leaks into another
+    // system created at the same address
+    const unsigned int id = nextId()++;
+
+    static std::atomic<unsigned int>& nextId() {
+        static std::atomic<unsigned int> counter{ 1 };
+        return counter;
+    }
+
+    struct ThreadSlot {
+        unsigned int system = 0;
+        int index = 0;
+    };
+    static ThreadSlot& threadSlot() {
+        thread_local ThreadSlot slot;
+        return slot;
+    }
+
+    int ownSlotIndex() {
+        ThreadSlot& cached = threadSlot();
+        if (cached.system == id) return cached.index;
+
+        std::lock_guard<std::mutex> lock(externalMutex);
+        std::thread::id self = std::this_thread::get_id();
+        auto found = std::find(externalThreads.begin(), externalThreads.end(), self);
+        if (found == externalThreads.end()) {
+            if (externalThreads.size() == MAX_EXTERNAL_THREADS)
+                throw std::runtime_error("JobSystem: too many threads submitting jobs");
+            found = externalThreads.insert(externalThreads.end(), self);
+        }
+        cached = { id, (int)(found - externalThreads.begin()) };
+        return cached.index;
+    }
+
+    Slot& ownSlot() { return *slots[ownSlotIndex()]; }
+
+    // Own deque first, then steal round the others
+    Job* takeJob(int index) {
+        Job* job = slots[index]->deque.pop();
+        for (size_t i = 1; !job && i < slots.size(); i++)
+            job = slots[(index + i) % slots.size()]->deque.steal();
+        if (job) queuedJobs.fetch_sub(1);
+        return job;
+    }
+
+    void execute(Job* job) {
+        job->function(*job);
+        finish(job);
+    }
+
+    // Once its counter reaches zero a job may be reused, so read its parent first
+    void finish(Job* job) {
+        while (job) {
+            Job* parent = job->parent;
+            if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            job = parent;
+        }
+    }
+
+    void workerLoop(int index) {
+        threadSlot() = { id, index };
+        if (Profiler::isEnabled()) Profiler::get().setThreadName("job worker");
+
+        while (true) {
+            if (Job* job = takeJob(index)) {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers.fetch_add(1);
+            wake.wait(lock, [this] { return stopping || queuedJobs.load() > 0; });
+            sleepingWorkers.fetch_sub(1);
+            if (stopping) return;
+        }
+    }
+
+    void stopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+        workers.clear();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+};
+
+#endif
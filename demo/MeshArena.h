@@ -0,0 +1,186 @@
+#ifndef MESH_ARENA_H
+#define MESH_ARENA_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "InstanceBuffer.h"
+#include "VertexCompression.h"
+
+// CPU-side geometry for one mesh.
+// Positions only (3 floats per vertex), which is all vertexShader.vs reads.
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Where a mesh lives inside the arena buffers
+struct MeshRange {
+    int baseVertex;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    VertexCompression::Decode decode;   // from the packed positions to object space
+};
+
+// GPU vertex: the position as 16-bit normalized integers against the mesh's
+// box, 8 bytes where three floats take 12. w only keeps positions 4-byte aligned.
+struct PackedVertex {
+    int16_t position[3];
+    int16_t w;
+};
+
+// Instances draw() took while capturing (see MeshArena::capture)
+struct CapturedDraw {
+    MeshRange range;
+    std::vector<InstanceData> instances;
+};
+
+// One vertex buffer, one index buffer and one VAO shared by every static mesh.
+// Meshes are appended with add() and drawn with glDrawElementsInstancedBaseVertex,
+// so switching meshes never changes the VAO or buffer bindings. The arena VAO is
+// the only VAO in the demo: it is bound on first use and stays bound.
+// The GPU gets PackedVertex; each draw sets its mesh's decode as the constant
+// value of attributes 6 and 7, which have no array behind them. The float copy
+// stays for the software rasterizer.
+class MeshArena {
+public:
+    static MeshArena& get() {
+        static MeshArena arena;
+        return arena;
+    }
+
+    // Append a mesh; the GPU copy is refreshed on the next bind()
+    MeshRange add(const MeshData& data) {
+        MeshRange range;
+        range.baseVertex = (int)(vertices.size() / 3);
+        range.firstIndex = (unsigned int)indices.size();
+        range.indexCount = (unsigned int)data.indices.size();
+
+        size_t count = data.vertices.size() / 3;
+        range.decode = VertexCompression::fit(data.vertices.data(), count, 3);
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 position(data.vertices[i * 3], data.vertices[i * 3 + 1], data.vertices[i * 3 + 2]);
+            PackedVertex vertex = {};
+            VertexCompression::packPosition(position, range.decode, vertex.position);
+            error.addPosition(position, vertex.position, range.decode);
+            packed.push_back(vertex);
+        }
+
+        vertices.insert(vertices.end(), data.vertices.begin(), data.vertices.end());
+        indices.insert(indices.end(), data.indices.begin(), data.indices.end());
+        dirty = true;
+        return range;
+    }
+
+    // Make the arena VAO current, uploading any meshes added since the last bind
+    void bind() {
+        if (!VAO) create();
+        if (dirty) upload();
+        if (!bound) {
+            glBindVertexArray(VAO);
+            bound = true;
+        }
+    }
+
+    // Upload the queued instances and draw them with one instanced call
+    void draw(const MeshRange& range, std::vector<InstanceData>& instances) {
+        if (instances.empty()) return;
+        if (captured) {
+            captured->push_back({ range, {} });
+            captured->back().instances.swap(instances);
+            return;
+        }
+
+        bind();
+        batch.upload(instances);
+        glVertexAttrib3fv(6, &range.decode.scale.x);
+        glVertexAttrib3fv(7, &range.decode.offset.x);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+            (void*)(range.firstIndex * sizeof(unsigned int)), (GLsizei)instances.size(), range.baseVertex);
+        instances.clear();
+    }
+
+    // Drop every mesh and the GL objects (called once nothing references the arena)
+    void reset() {
+        if (VAO) {
+            if (bound) glBindVertexArray(0);
+            glDeleteVertexArrays(1, &VAO);
+            glDeleteBuffers(1, &VBO);
+            glDeleteBuffers(1, &EBO);
+            batch.destroy();
+        }
+        VAO = VBO = EBO = 0;
+        bound = false;
+        dirty = false;
+        vertices.clear();
+        packed.clear();
+        indices.clear();
+        error = VertexCompression::Error();
+    }
+
+    size_t vertexCount() const { return vertices.size() / 3; }
+    size_t indexCount() const { return indices.size(); }
+
+    // While 'list' is set, draw() appends to it instead of calling GL, so the
+    // software rasterizer gets exactly what the flush() calls would draw
+    void capture(std::vector<CapturedDraw>* list) { captured = list; }
+
+    // The CPU copy, for the software rasterizer
+    const std::vector<float>& vertexData() const { return vertices; }
+    const std::vector<unsigned int>& indexData() const { return indices; }
+
+    // Vertex buffer size as floats and as uploaded, and how far the packed
+    // positions are from the floats (for --vertex-report)
+    size_t floatVertexBytes() const { return vertices.size() * sizeof(float); }
+    size_t packedVertexBytes() const { return packed.size() * sizeof(PackedVertex); }
+    const VertexCompression::Error& compressionError() const { return error; }
+
+private:
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    InstanceBuffer batch;
+    std::vector<float> vertices;
+    std::vector<PackedVertex> packed;
+    std::vector<unsigned int> indices;
+    VertexCompression::Error error;
+    bool dirty = false;
+    bool bound = false;
+    std::vector<CapturedDraw>* captured = nullptr;
+
+    MeshArena() {}
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    void create() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // Position attribute, unpacked to [-1, 1]
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+        glEnableVertexAttribArray(0);
+
+        // Per-instance model matrix and color
+        batch.attach();
+
+        bound = true;
+    }
+
+    // Meshes are only added at startup, so the whole arena is re-uploaded
+    void upload() {
+        if (!bound) {
+            glBindVertexArray(VAO);
+            bound = true;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        dirty = false;
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <map>
+#include <functional>
+#include "MeshArena.h"
+
+// Primitive shapes known to the cache
+enum MeshType {
+    MESH_CUBE,
+    MESH_SPHERE,
+    MESH_CYLINDER,
+    MESH_HEXAGON,
+    MESH_WEDGE
+};
+
+// Identifies one tessellated mesh: the primitive type plus its generation
+// parameters (radius, sectorCount, stackCount, ...; unused slots stay 0)
+struct MeshKey {
+    MeshType type;
+    float params[4];
+
+    MeshKey(MeshType t, float p0 = 0.0f, float p1 = 0.0f, float p2 = 0.0f, float p3 = 0.0f)
+        : type(t), params{ p0, p1, p2, p3 } {
+    }
+
+    bool operator<(const MeshKey& other) const {
+        if (type != other.type) return type < other.type;
+        for (int i = 0; i < 4; i++)
+            if (params[i] != other.params[i]) return params[i] < other.params[i];
+        return false;
+    }
+};
+
+struct Mesh;
+
+// One level of a mesh's LOD chain (see MeshLod.h)
+struct MeshLodLevel {
+    Mesh* mesh;
+    float chordError;   // largest gap between the mesh and the true surface, relative to its radius
+};
+
+// A cached mesh: its slice of the arena plus the instances queued for it.
+// Every primitive built with the same key shares one Mesh, so they batch together.
+struct Mesh {
+    MeshRange range;
+    std::vector<InstanceData> instances;
+    int refCount;
+
+    // Coarser versions of this mesh, coarsest first and ending with the mesh
+    // itself; empty for meshes without levels of detail. lodExtent is the
+    // radius of the round cross-section along each model axis.
+    std::vector<MeshLodLevel> lodLevels;
+    glm::vec3 lodExtent = glm::vec3(0.0f);
+
+    void add(const glm::mat4& model, const glm::vec3& color) {
+        instances.push_back({ model, color });
+    }
+
+    // Draw every queued instance with one instanced call
+    void flush() {
+        MeshArena::get().draw(range, instances);
+    }
+};
+
+// Process-wide cache of procedural meshes. acquire() generates a mesh into the
+// arena the first time its key is seen and hands out the same Mesh afterwards;
+// release() drops it once the last user is gone.
+class MeshCache {
+public:
+    static MeshCache& get() {
+        static MeshCache cache;
+        return cache;
+    }
+
+    Mesh* acquire(const MeshKey& key, const std::function<void(MeshData&)>& build) {
+        auto it = meshes.find(key);
+        if (it != meshes.end()) {
+            it->second->refCount++;
+            return it->second;
+        }
+
+        MeshData data;
+        build(data);
+
+        Mesh* mesh = new Mesh();
+        mesh->range = MeshArena::get().add(data);
+        mesh->refCount = 1;
+
+        meshes[key] = mesh;
+        return mesh;
+    }
+
+    void release(Mesh* mesh) {
+        if (!mesh || --mesh->refCount > 0) return;
+
+        for (auto it = meshes.begin(); it != meshes.end(); ++it) {
+            if (it->second == mesh) {
+                meshes.erase(it);
+                break;
+            }
+        }
+
+        // The coarser levels were acquired along with the mesh
+        for (const MeshLodLevel& level : mesh->lodLevels)
+            if (level.mesh != mesh) release(level.mesh);
+        delete mesh;
+
+        // Arena space is not reused piecemeal; it is reclaimed once every mesh is gone
+        if (meshes.empty())
+            MeshArena::get().reset();
+    }
+
+    // Number of distinct meshes currently in the arena
+    size_t size() const { return meshes.size(); }
+
+private:
+    std::map<MeshKey, Mesh*> meshes;
+
+    MeshCache() {}
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+};
+
+#endif
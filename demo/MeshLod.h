@@ -0,0 +1,108 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "MeshCache.h"
+
+// Screen-space level of detail for the round primitives. Sphere and Cylinder
+// also build their mesh with LOD_SECTORS sectors (those below their own
+// count), and each draw takes the coarsest level whose chord error - the gap
+// between the true circle and a polygon of that many sides,
+//
+//     projected radius * (1 - cos(pi / sectors))
+//
+// stays under MAX_ERROR_PIXELS. A part near a boundary would flip between two
+// levels as it moves, so a draw keeps the level it had last frame until the
+// error passes the limit by HYSTERESIS, or a coarser level gets that far below it.
+namespace MeshLod {
+    constexpr int LOD_SECTORS[] = { 6, 12, 24 };
+    constexpr float MAX_ERROR_PIXELS = 0.5f;
+    constexpr float HYSTERESIS = 0.25f;
+
+    // Switched off by --no-lod: every draw uses the full mesh
+    inline bool& enabled() {
+        static bool on = true;
+        return on;
+    }
+
+    inline float chordError(int sectors) {
+        return 1.0f - std::cos(3.14159265359f / sectors);
+    }
+
+    // Append 'level' (built with 'sectors' sectors) to the chain of 'mesh'
+    inline void addLevel(Mesh* mesh, Mesh* level, int sectors) {
+        mesh->lodLevels.push_back({ level, chordError(sectors) });
+    }
+
+    // The camera levels are picked for. A default View turns LOD off.
+    struct View {
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        float pixelsPerUnit = 0.0f;   // pixels per world unit at clip w = 1
+        bool perspective = false;
+
+        View() {}
+        View(const glm::mat4& projection, const glm::mat4& view, float viewportHeight)
+            : viewProjection(projection * view), pixelsPerUnit(projection[1][1] * viewportHeight * 0.5f),
+            perspective(projection[3][3] == 0.0f) {
+        }
+
+        // Radius in pixels of the round cross-section of 'mesh' drawn at 'model'
+        float projectedRadius(const Mesh& mesh, const glm::mat4& model) const {
+            float radius = std::max({ glm::length(glm::vec3(model[0])) * mesh.lodExtent.x,
+                glm::length(glm::vec3(model[1])) * mesh.lodExtent.y,
+                glm::length(glm::vec3(model[2])) * mesh.lodExtent.z });
+            if (!perspective) return radius * pixelsPerUnit;
+            // Parts reaching the eye are either clipped or fill the view
+            float w = (viewProjection * model[3]).w;
+            if (w <= radius) return 1e6f;
+            return radius * pixelsPerUnit / w;
+        }
+    };
+
+    // Level of 'mesh' for a draw 'radius' pixels across that used 'previous'
+    // last frame (-1 when it has none)
+    inline int select(const Mesh& mesh, float radius, int previous) {
+        int finest = (int)mesh.lodLevels.size() - 1;
+        auto error = [&](int level) { return radius * mesh.lodLevels[level].chordError; };
+
+        if (previous < 0 || previous > finest) {
+            int level = 0;
+            while (level < finest && error(level) > MAX_ERROR_PIXELS) level++;
+            return level;
+        }
+        int level = previous;
+        while (level < finest && error(level) > MAX_ERROR_PIXELS * (1.0f + HYSTERESIS)) level++;
+        while (level > 0 && error(level - 1) < MAX_ERROR_PIXELS * (1.0f - HYSTERESIS)) level--;
+        return level;
+    }
+
+    inline bool active(const Mesh& mesh, const View& view) {
+        return enabled() && view.pixelsPerUnit > 0.0f && !mesh.lodLevels.empty();
+    }
+
+    // Queue one instance of 'mesh' at the level picked for 'view' and return
+    // that level, to pass as 'previous' next frame
+    inline int add(Mesh& mesh, const View& view, const glm::mat4& model, const glm::vec3& color, int previous) {
+        if (!active(mesh, view)) {
+            mesh.add(model, color);
+            return -1;
+        }
+        int level = select(mesh, view.projectedRadius(mesh, model), previous);
+        mesh.lodLevels[level].mesh->add(model, color);
+        return level;
+    }
+
+    // Draw the queued instances of every level
+    inline void flush(Mesh& mesh) {
+        if (mesh.lodLevels.empty()) {
+            mesh.flush();
+            return;
+        }
+        for (const MeshLodLevel& level : mesh.lodLevels)
+            level.mesh->flush();
+    }
+}
+
+#endif
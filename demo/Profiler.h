@@ -0,0 +1,176 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped CPU zones:
+//
+//     void update() {
+//         PROFILE_ZONE("update");
+//         ...
+//     }
+//
+// A zone records its name and start/end time (ns) into a ring buffer owned by
+// the calling thread, so recording never takes a lock. While the profiler is
+// disabled a zone costs one relaxed atomic load; define PROFILER_COMPILED_OUT
+// to remove the zones entirely. writeChromeTrace() exports the recorded zones
+// as trace-event JSON for chrome://tracing or https://ui.perfetto.dev.
+
+// One finished zone. Names must be string literals; they are stored, not copied.
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+// Ring of events written by exactly one thread. The owner publishes each event
+// by advancing 'written'; once full, the oldest events are overwritten.
+struct ProfileThreadBuffer {
+    static const size_t CAPACITY = 1 << 16;
+
+    ProfileEvent events[CAPACITY];
+    std::atomic<uint64_t> written{ 0 };
+    unsigned int threadId = 0;
+    const char* threadName = nullptr;
+
+    void push(const char* name, uint64_t startNs, uint64_t endNs) {
+        uint64_t index = written.load(std::memory_order_relaxed);
+        events[index & (CAPACITY - 1)] = { name, startNs, endNs };
+        written.store(index + 1, std::memory_order_release);
+    }
+};
+
+class Profiler {
+public:
+    static Profiler& get() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Nanoseconds since the profiler was created
+    uint64_t now() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin).count();
+    }
+
+    // The calling thread's buffer, registered on first use
+    ProfileThreadBuffer& threadBuffer() {
+        thread_local ProfileThreadBuffer* buffer = registerThread();
+        return *buffer;
+    }
+
+    // Label the calling thread in the trace (a string literal)
+    void setThreadName(const char* name) {
+        threadBuffer().threadName = name;
+    }
+
+    // An extra named track for events that do not belong to a CPU thread (GPU
+    // timings). Like a thread buffer it must only be written from one thread.
+    ProfileThreadBuffer* createTrack(const char* name) {
+        ProfileThreadBuffer* track = registerThread();
+        track->threadName = name;
+        return track;
+    }
+
+    // Write every recorded zone as Chrome trace-event JSON ("X" complete events,
+    // microsecond timestamps). Call while no zones are being recorded.
+    bool writeChromeTrace(const std::string& path) {
+        std::ofstream file(path);
+        if (!file) return false;
+
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::unique_ptr<ProfileThreadBuffer>& buffer : buffers) {
+            if (buffer->threadName) {
+                file << (first ? "" : ",\n")
+                    << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                    << ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+                first = false;
+            }
+
+            uint64_t end = buffer->written.load(std::memory_order_acquire);
+            uint64_t begin = end > ProfileThreadBuffer::CAPACITY ? end - ProfileThreadBuffer::CAPACITY : 0;
+            for (uint64_t i = begin; i < end; i++) {
+                const ProfileEvent& event = buffer->events[i & (ProfileThreadBuffer::CAPACITY - 1)];
+                file << (first ? "" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                    << ",\"ts\":" << microseconds(event.startNs)
+                    << ",\"dur\":" << microseconds(event.endNs - event.startNs) << "}";
+                first = false;
+            }
+        }
+        file << "\n]}\n";
+        return true;
+    }
+
+private:
+    static inline std::atomic<bool> enabled{ false };
+
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers;
+
+    Profiler() {}
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    ProfileThreadBuffer* registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(std::make_unique<ProfileThreadBuffer>());
+        buffers.back()->threadId = (unsigned int)buffers.size();
+        return buffers.back().get();
+    }
+
+    // Integer microseconds plus three decimals, so nanoseconds survive
+    static std::string microseconds(uint64_t ns) {
+        std::string fraction = std::to_string(ns % 1000);
+        return std::to_string(ns / 1000) + "." + std::string(3 - fraction.size(), '0') + fraction;
+    }
+};
+
+// RAII marker behind PROFILE_ZONE
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* zoneName) {
+        if (Profiler::isEnabled()) {
+            name = zoneName;
+            startNs = Profiler::get().now();
+        }
+    }
+
+    ~ProfileZone() {
+        if (name) {
+            Profiler& profiler = Profiler::get();
+            profiler.threadBuffer().push(name, startNs, profiler.now());
+        }
+    }
+
+private:
+    const char* name = nullptr;
+    uint64_t startNs = 0;
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_COMPILED_OUT
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
+
+#endif
@@ -2,13 +2,17 @@
 #define SHIP_H
 
 #include "Cube.h"
+#include "SceneNode.h"
 #include "Sphere.h"
 #include "Cylinder.h"
 #include "Wedge.h"
 #include "Hexagon.h"
+#include "MeshLod.h"
 #include "ShipConfig.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
 #include <glm/glm.hpp>
-#include "Shader.h"
+#include <vector>
 
 class Ship {
 private:
@@ -19,164 +23,302 @@ private:
     Wedge wedge;
     Hexagon hexagon;
 
-public:
-    Ship() : sphere(0.5f, 36, 18), cylinder(0.5f, 0.5f, 1.0f, 36), cone(0.5f, 0.0f, 1.0f, 36) {}
+    // Part tree built once in the constructor, one child of root per hull section
+    struct PartGroup {
+        const char* name;
+        SceneNode* node;
+    };
+    SceneNode root;
+    std::vector<PartGroup> groups;
+
+    // Flattened part list for recordFleet(): each part's matrix relative to the
+    // ship and its slot among the ship's instances of the same mesh
+    struct FleetMesh {
+        Mesh* mesh;
+        size_t partsPerShip;
+        size_t first;   // first instance written by the current recordFleet()
+        std::vector<signed char> lodLevels;   // per instance, from the last recordFleet()
+    };
+    struct FleetPart {
+        size_t meshIndex;
+        size_t slot;
+        glm::mat4 local;
+        glm::vec3 color;
+    };
+    std::vector<FleetMesh> fleetMeshes;
+    std::vector<FleetPart> fleetParts;
+
+    MeshLod::View lodView;
 
-    void draw(Shader& shader, glm::mat4 parentModel) {
+    void collectFleetParts() {
+        root.setParentMatrix(glm::mat4(1.0f));
+        for (const PartGroup& group : groups) {
+            group.node->visitDrawables([this](SceneNode& node) {
+                size_t meshIndex = 0;
+                while (meshIndex < fleetMeshes.size() && fleetMeshes[meshIndex].mesh != node.mesh)
+                    meshIndex++;
+                if (meshIndex == fleetMeshes.size())
+                    fleetMeshes.push_back({ node.mesh, 0, 0, {} });
+                fleetParts.push_back({ meshIndex, fleetMeshes[meshIndex].partsPerShip++, node.getWorld(), node.color });
+            });
+        }
+    }
+
+    SceneNode* addGroup(const char* name) {
+        SceneNode* node = root.addChild();
+        groups.push_back({ name, node });
+        return node;
+    }
+
+public:
+    // Build the part tree once; every part is static relative to the root
+    Ship() : sphere(0.5f, 36, 18), cylinder(0.5f, 0.5f, 1.0f, 36), cone(0.5f, 0.0f, 1.0f, 36) {
         using namespace ShipConfig;
-        
+        SceneNode* group;
+
         // ============== MAIN FUSELAGE ==============
-        hexagon.draw(shader, parentModel,
+        group = addGroup("Ship fuselage");
+        group->addPart(hexagon.getMesh(),
             Fuselage::MAIN_POS.x, Fuselage::MAIN_POS.y, Fuselage::MAIN_POS.z,
             Fuselage::MAIN_ROT.x, Fuselage::MAIN_ROT.y, Fuselage::MAIN_ROT.z,
             Fuselage::MAIN_SCALE.x, Fuselage::MAIN_SCALE.y, Fuselage::MAIN_SCALE.z,
             Colors::DARK_GUNMETAL);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Fuselage::ARMOR_POS.x, Fuselage::ARMOR_POS.y, Fuselage::ARMOR_POS.z,
             Fuselage::ARMOR_ROT.x, Fuselage::ARMOR_ROT.y, Fuselage::ARMOR_ROT.z,
             Fuselage::ARMOR_SCALE.x, Fuselage::ARMOR_SCALE.y, Fuselage::ARMOR_SCALE.z,
             Colors::ARMOR_PLATE);
 
         // ============== NOSE SECTION ==============
-        cone.draw(shader, parentModel,
+        group = addGroup("Ship nose");
+        group->addPart(cone.getMesh(),
             Nose::CONE_POS.x, Nose::CONE_POS.y, Nose::CONE_POS.z,
             Nose::CONE_ROT.x, Nose::CONE_ROT.y, Nose::CONE_ROT.z,
             Nose::CONE_SCALE.x, Nose::CONE_SCALE.y, Nose::CONE_SCALE.z,
             Colors::NOSE_TIP);
 
-        cylinder.draw(shader, parentModel,
+        group->addPart(cylinder.getMesh(),
             Nose::RING_POS.x, Nose::RING_POS.y, Nose::RING_POS.z,
             Nose::RING_ROT.x, Nose::RING_ROT.y, Nose::RING_ROT.z,
             Nose::RING_SCALE.x, Nose::RING_SCALE.y, Nose::RING_SCALE.z,
             Colors::CYAN_ACCENT);
 
         // ============== COCKPIT ==============
-        sphere.draw(shader, parentModel,
+        group = addGroup("Ship cockpit");
+        group->addPart(sphere.getMesh(),
             Cockpit::CANOPY_POS.x, Cockpit::CANOPY_POS.y, Cockpit::CANOPY_POS.z,
             Cockpit::CANOPY_ROT.x, Cockpit::CANOPY_ROT.y, Cockpit::CANOPY_ROT.z,
             Cockpit::CANOPY_SCALE.x, Cockpit::CANOPY_SCALE.y, Cockpit::CANOPY_SCALE.z,
             Colors::BLUE_GLASS);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Cockpit::FRAME_POS.x, Cockpit::FRAME_POS.y, Cockpit::FRAME_POS.z,
             Cockpit::FRAME_ROT.x, Cockpit::FRAME_ROT.y, Cockpit::FRAME_ROT.z,
             Cockpit::FRAME_SCALE.x, Cockpit::FRAME_SCALE.y, Cockpit::FRAME_SCALE.z,
             Colors::PANEL_DARK);
 
         // ============== WINGS ==============
-        wedge.draw(shader, parentModel,
+        group = addGroup("Ship wings");
+        group->addPart(wedge.getMesh(),
             Wings::LEFT_MAIN_POS.x, Wings::LEFT_MAIN_POS.y, Wings::LEFT_MAIN_POS.z,
             Wings::LEFT_MAIN_ROT.x, Wings::LEFT_MAIN_ROT.y, Wings::LEFT_MAIN_ROT.z,
             Wings::LEFT_MAIN_SCALE.x, Wings::LEFT_MAIN_SCALE.y, Wings::LEFT_MAIN_SCALE.z,
             Colors::GUNMETAL);
 
-        wedge.draw(shader, parentModel,
+        group->addPart(wedge.getMesh(),
             Wings::RIGHT_MAIN_POS.x, Wings::RIGHT_MAIN_POS.y, Wings::RIGHT_MAIN_POS.z,
             Wings::RIGHT_MAIN_ROT.x, Wings::RIGHT_MAIN_ROT.y, Wings::RIGHT_MAIN_ROT.z,
             Wings::RIGHT_MAIN_SCALE.x, Wings::RIGHT_MAIN_SCALE.y, Wings::RIGHT_MAIN_SCALE.z,
             Colors::GUNMETAL);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Wings::LEFT_TIP_POS.x, Wings::LEFT_TIP_POS.y, Wings::LEFT_TIP_POS.z,
             Wings::LEFT_TIP_ROT.x, Wings::LEFT_TIP_ROT.y, Wings::LEFT_TIP_ROT.z,
             Wings::LEFT_TIP_SCALE.x, Wings::LEFT_TIP_SCALE.y, Wings::LEFT_TIP_SCALE.z,
             Colors::RED_ACCENT);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Wings::RIGHT_TIP_POS.x, Wings::RIGHT_TIP_POS.y, Wings::RIGHT_TIP_POS.z,
             Wings::RIGHT_TIP_ROT.x, Wings::RIGHT_TIP_ROT.y, Wings::RIGHT_TIP_ROT.z,
             Wings::RIGHT_TIP_SCALE.x, Wings::RIGHT_TIP_SCALE.y, Wings::RIGHT_TIP_SCALE.z,
             Colors::RED_ACCENT);
 
         // ============== ENGINE NACELLES ==============
-        cylinder.draw(shader, parentModel,
+        group = addGroup("Ship engines");
+        group->addPart(cylinder.getMesh(),
             Engines::LEFT_POD_POS.x, Engines::LEFT_POD_POS.y, Engines::LEFT_POD_POS.z,
             Engines::LEFT_POD_ROT.x, Engines::LEFT_POD_ROT.y, Engines::LEFT_POD_ROT.z,
             Engines::LEFT_POD_SCALE.x, Engines::LEFT_POD_SCALE.y, Engines::LEFT_POD_SCALE.z,
             Colors::DARK_GRAY);
 
-        cylinder.draw(shader, parentModel,
+        group->addPart(cylinder.getMesh(),
             Engines::LEFT_INTAKE_POS.x, Engines::LEFT_INTAKE_POS.y, Engines::LEFT_INTAKE_POS.z,
             Engines::LEFT_INTAKE_ROT.x, Engines::LEFT_INTAKE_ROT.y, Engines::LEFT_INTAKE_ROT.z,
             Engines::LEFT_INTAKE_SCALE.x, Engines::LEFT_INTAKE_SCALE.y, Engines::LEFT_INTAKE_SCALE.z,
             Colors::ALMOST_BLACK);
 
-        sphere.draw(shader, parentModel,
+        group->addPart(sphere.getMesh(),
             Engines::LEFT_EXHAUST_POS.x, Engines::LEFT_EXHAUST_POS.y, Engines::LEFT_EXHAUST_POS.z,
             Engines::LEFT_EXHAUST_ROT.x, Engines::LEFT_EXHAUST_ROT.y, Engines::LEFT_EXHAUST_ROT.z,
             Engines::LEFT_EXHAUST_SCALE.x, Engines::LEFT_EXHAUST_SCALE.y, Engines::LEFT_EXHAUST_SCALE.z,
             Colors::ORANGE_THRUST);
 
-        cylinder.draw(shader, parentModel,
+        group->addPart(cylinder.getMesh(),
             Engines::RIGHT_POD_POS.x, Engines::RIGHT_POD_POS.y, Engines::RIGHT_POD_POS.z,
             Engines::RIGHT_POD_ROT.x, Engines::RIGHT_POD_ROT.y, Engines::RIGHT_POD_ROT.z,
             Engines::RIGHT_POD_SCALE.x, Engines::RIGHT_POD_SCALE.y, Engines::RIGHT_POD_SCALE.z,
             Colors::DARK_GRAY);
 
-        cylinder.draw(shader, parentModel,
+        group->addPart(cylinder.getMesh(),
             Engines::RIGHT_INTAKE_POS.x, Engines::RIGHT_INTAKE_POS.y, Engines::RIGHT_INTAKE_POS.z,
             Engines::RIGHT_INTAKE_ROT.x, Engines::RIGHT_INTAKE_ROT.y, Engines::RIGHT_INTAKE_ROT.z,
             Engines::RIGHT_INTAKE_SCALE.x, Engines::RIGHT_INTAKE_SCALE.y, Engines::RIGHT_INTAKE_SCALE.z,
             Colors::ALMOST_BLACK);
 
-        sphere.draw(shader, parentModel,
+        group->addPart(sphere.getMesh(),
             Engines::RIGHT_EXHAUST_POS.x, Engines::RIGHT_EXHAUST_POS.y, Engines::RIGHT_EXHAUST_POS.z,
             Engines::RIGHT_EXHAUST_ROT.x, Engines::RIGHT_EXHAUST_ROT.y, Engines::RIGHT_EXHAUST_ROT.z,
             Engines::RIGHT_EXHAUST_SCALE.x, Engines::RIGHT_EXHAUST_SCALE.y, Engines::RIGHT_EXHAUST_SCALE.z,
             Colors::ORANGE_THRUST);
 
         // ============== VERTICAL STABILIZERS ==============
-        wedge.draw(shader, parentModel,
+        group = addGroup("Ship stabilizers");
+        group->addPart(wedge.getMesh(),
             Stabilizers::MAIN_FIN_POS.x, Stabilizers::MAIN_FIN_POS.y, Stabilizers::MAIN_FIN_POS.z,
             Stabilizers::MAIN_FIN_ROT.x, Stabilizers::MAIN_FIN_ROT.y, Stabilizers::MAIN_FIN_ROT.z,
             Stabilizers::MAIN_FIN_SCALE.x, Stabilizers::MAIN_FIN_SCALE.y, Stabilizers::MAIN_FIN_SCALE.z,
             Colors::GUNMETAL);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Stabilizers::FIN_ACCENT_POS.x, Stabilizers::FIN_ACCENT_POS.y, Stabilizers::FIN_ACCENT_POS.z,
             Stabilizers::FIN_ACCENT_ROT.x, Stabilizers::FIN_ACCENT_ROT.y, Stabilizers::FIN_ACCENT_ROT.z,
             Stabilizers::FIN_ACCENT_SCALE.x, Stabilizers::FIN_ACCENT_SCALE.y, Stabilizers::FIN_ACCENT_SCALE.z,
             Colors::CYAN_ACCENT);
 
         // ============== WEAPONS / DETAILS ==============
-        cylinder.draw(shader, parentModel,
+        group = addGroup("Ship weapons");
+        group->addPart(cylinder.getMesh(),
             Weapons::LEFT_CANNON_POS.x, Weapons::LEFT_CANNON_POS.y, Weapons::LEFT_CANNON_POS.z,
             Weapons::LEFT_CANNON_ROT.x, Weapons::LEFT_CANNON_ROT.y, Weapons::LEFT_CANNON_ROT.z,
             Weapons::LEFT_CANNON_SCALE.x, Weapons::LEFT_CANNON_SCALE.y, Weapons::LEFT_CANNON_SCALE.z,
             Colors::WEAPON_METAL);
 
-        cylinder.draw(shader, parentModel,
+        group->addPart(cylinder.getMesh(),
             Weapons::RIGHT_CANNON_POS.x, Weapons::RIGHT_CANNON_POS.y, Weapons::RIGHT_CANNON_POS.z,
             Weapons::RIGHT_CANNON_ROT.x, Weapons::RIGHT_CANNON_ROT.y, Weapons::RIGHT_CANNON_ROT.z,
             Weapons::RIGHT_CANNON_SCALE.x, Weapons::RIGHT_CANNON_SCALE.y, Weapons::RIGHT_CANNON_SCALE.z,
             Colors::WEAPON_METAL);
 
-        sphere.draw(shader, parentModel,
+        group->addPart(sphere.getMesh(),
             Details::SENSOR_POS.x, Details::SENSOR_POS.y, Details::SENSOR_POS.z,
             Details::SENSOR_ROT.x, Details::SENSOR_ROT.y, Details::SENSOR_ROT.z,
             Details::SENSOR_SCALE.x, Details::SENSOR_SCALE.y, Details::SENSOR_SCALE.z,
             Colors::YELLOW_SENSOR);
 
         // ============== HULL DETAILS ==============
-        cube.draw(shader, parentModel,
+        group = addGroup("Ship hull details");
+        group->addPart(cube.getMesh(),
             Details::LEFT_PANEL_POS.x, Details::LEFT_PANEL_POS.y, Details::LEFT_PANEL_POS.z,
             Details::LEFT_PANEL_ROT.x, Details::LEFT_PANEL_ROT.y, Details::LEFT_PANEL_ROT.z,
             Details::LEFT_PANEL_SCALE.x, Details::LEFT_PANEL_SCALE.y, Details::LEFT_PANEL_SCALE.z,
             Colors::VERY_DARK_GRAY);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Details::RIGHT_PANEL_POS.x, Details::RIGHT_PANEL_POS.y, Details::RIGHT_PANEL_POS.z,
             Details::RIGHT_PANEL_ROT.x, Details::RIGHT_PANEL_ROT.y, Details::RIGHT_PANEL_ROT.z,
             Details::RIGHT_PANEL_SCALE.x, Details::RIGHT_PANEL_SCALE.y, Details::RIGHT_PANEL_SCALE.z,
             Colors::VERY_DARK_GRAY);
 
-        cube.draw(shader, parentModel,
+        group->addPart(cube.getMesh(),
             Details::UNDERCARRIAGE_POS.x, Details::UNDERCARRIAGE_POS.y, Details::UNDERCARRIAGE_POS.z,
             Details::UNDERCARRIAGE_ROT.x, Details::UNDERCARRIAGE_ROT.y, Details::UNDERCARRIAGE_ROT.z,
             Details::UNDERCARRIAGE_SCALE.x, Details::UNDERCARRIAGE_SCALE.y, Details::UNDERCARRIAGE_SCALE.z,
             Colors::DARKER_GRAY);
     }
+
+    // Draw one ship right away (one instanced call per mesh type)
+    void draw(glm::mat4 parentModel) {
+        PROFILE_ZONE("Ship::draw");
+        record(parentModel);
+        flush();
+    }
+
+    // Camera the round parts pick their level of detail for (see MeshLod.h);
+    // without one every part is drawn at full detail
+    void setLodView(const MeshLod::View& view) {
+        lodView = view;
+    }
+
+    // Queue every part of a ship placed at parentModel. Call this once per ship
+    // of a fleet, then flush() once to draw the whole fleet. Part world matrices
+    // are cached and only recomputed when parentModel differs from the last call.
+    void record(glm::mat4 parentModel) {
+        root.setParentMatrix(parentModel);
+        for (const PartGroup& group : groups) {
+            PROFILE_ZONE(group.name);
+            group.node->visitDrawables([this](SceneNode& node) {
+                node.lodLevel = MeshLod::add(*node.mesh, lodView, node.getWorld(), node.color, node.lodLevel);
+            });
+        }
+    }
+
+    // Queue every part of a ship at each of shipModels; flush() draws them. The
+    // ships are split across the job system: each ship's instances go to fixed
+    // slots of each mesh's list, so threads never write the same element. The
+    // level of detail of a round part is picked in the same pass; the parts
+    // below full detail are moved to their level's list afterwards.
+    void recordFleet(const std::vector<glm::mat4>& shipModels) {
+        PROFILE_ZONE("Ship::recordFleet");
+        if (fleetParts.empty()) collectFleetParts();
+
+        for (FleetMesh& fleetMesh : fleetMeshes) {
+            size_t count = shipModels.size() * fleetMesh.partsPerShip;
+            fleetMesh.first = fleetMesh.mesh->instances.size();
+            fleetMesh.mesh->instances.resize(fleetMesh.first + count);
+            if (MeshLod::active(*fleetMesh.mesh, lodView) && fleetMesh.lodLevels.size() != count)
+                fleetMesh.lodLevels.assign(count, -1);
+        }
+        JobSystem::get().parallelFor(0, shipModels.size(), 16, [&](size_t begin, size_t end) {
+            for (size_t ship = begin; ship < end; ship++) {
+                for (const FleetPart& part : fleetParts) {
+                    FleetMesh& fleetMesh = fleetMeshes[part.meshIndex];
+                    size_t slot = ship * fleetMesh.partsPerShip + part.slot;
+                    InstanceData& instance = fleetMesh.mesh->instances[fleetMesh.first + slot];
+                    instance = { shipModels[ship] * part.local, part.color };
+                    if (MeshLod::active(*fleetMesh.mesh, lodView)) {
+                        fleetMesh.lodLevels[slot] = (signed char)MeshLod::select(*fleetMesh.mesh,
+                            lodView.projectedRadius(*fleetMesh.mesh, instance.model), fleetMesh.lodLevels[slot]);
+                    }
+                }
+            }
+        });
+
+        for (FleetMesh& fleetMesh : fleetMeshes) {
+            if (!MeshLod::active(*fleetMesh.mesh, lodView)) continue;
+            std::vector<InstanceData>& instances = fleetMesh.mesh->instances;
+            int finest = (int)fleetMesh.mesh->lodLevels.size() - 1;
+            size_t kept = fleetMesh.first;
+            for (size_t slot = 0; slot < fleetMesh.lodLevels.size(); slot++) {
+                const InstanceData& instance = instances[fleetMesh.first + slot];
+                int level = fleetMesh.lodLevels[slot];
+                if (level == finest) instances[kept++] = instance;
+                else fleetMesh.mesh->lodLevels[level].mesh->instances.push_back(instance);
+            }
+            instances.resize(kept);
+        }
+    }
+
+    // Draw all queued parts, one instanced draw per mesh type out of the shared arena
+    void flush() {
+        GPU_ZONE("Ship::flush");
+        hexagon.flush();
+        cube.flush();
+        cone.flush();
+        cylinder.flush();
+        sphere.flush();
+        wedge.flush();
+    }
 };
 
 #endif
@@ -4,44 +4,64 @@
 #include <glad/glad.h>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include "Shader.h"
+#include "MeshCache.h"
+#include "MeshLod.h"
+#include "TransformBatch.h"
 
 class Sphere {
 public:
     Sphere(float radius = 1.0f, int sectorCount = 36, int stackCount = 18) {
-        setUpSphere(radius, sectorCount, stackCount);
+        mesh = MeshCache::get().acquire(MeshKey(MESH_SPHERE, radius, (float)sectorCount, (float)stackCount),
+            [=](MeshData& data) { buildSphere(data, radius, sectorCount, stackCount); });
+
+        // Levels of detail keep the sector to stack ratio
+        if (mesh->lodLevels.empty()) {
+            for (int sectors : MeshLod::LOD_SECTORS) {
+                if (sectors >= sectorCount) break;
+                int stacks = std::max(2, stackCount * sectors / sectorCount);
+                MeshLod::addLevel(mesh, MeshCache::get().acquire(MeshKey(MESH_SPHERE, radius, (float)sectors, (float)stacks),
+                    [=](MeshData& data) { buildSphere(data, radius, sectors, stacks); }), sectors);
+            }
+            MeshLod::addLevel(mesh, mesh, sectorCount);
+            mesh->lodExtent = glm::vec3(radius);
+        }
     }
 
     ~Sphere() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        MeshCache::get().release(mesh);
     }
 
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
-        glm::mat4 t = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        glm::mat4 rX = glm::rotate(t, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-        glm::mat4 rY = glm::rotate(rX, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-        glm::mat4 rZ = glm::rotate(rY, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::mat4 m = glm::scale(rZ, glm::vec3(sx, sy, sz));
+    // Draw with explicit transformations (single instance, drawn immediately)
+    void draw(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+        submit(parentModel, tx, ty, tz, rx, ry, rz, sx, sy, sz, colorVec);
+        flush();
+    }
 
-        shader.setMat4("model", m);
-        shader.setVec3("customColor", colorVec);
+    // Queue one instance; nothing is drawn until flush()
+    void submit(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+        glm::mat4 m = parentModel * TransformBatch::composeTRS(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz), glm::vec3(sx, sy, sz));
+
+        mesh->add(m, colorVec);
+    }
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    // Draw every queued instance, one instanced call per level of detail
+    void flush() {
+        MeshLod::flush(*mesh);
     }
 
+    // Shared mesh, for scene graph parts that queue their own instances
+    Mesh* getMesh() const { return mesh; }
+
 private:
-    unsigned int VAO, VBO, EBO;
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    Mesh* mesh;
 
-    void setUpSphere(float radius, int sectorCount, int stackCount) {
+    static void buildSphere(MeshData& data, float radius, int sectorCount, int stackCount) {
+        std::vector<float>& vertices = data.vertices;
+        std::vector<unsigned int>& indices = data.indices;
         float x, y, z, xy;                              // vertex position
         float PI = 3.14159265359f;
         float sectorStep = 2 * PI / sectorCount;
@@ -114,20 +134,6 @@ private:
                 }
             }
         }
-
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
     }
 };
 
@@ -0,0 +1,171 @@
+#ifndef TRANSFORM_BATCH_H
+#define TRANSFORM_BATCH_H
+
+#include <vector>
+#include <cmath>
+#include <glm/glm.hpp>
+
+// glm only enables its SSE code paths (glm/simd) under GLM_FORCE_INTRINSICS, which
+// would change the alignment of every glm type in the project. The batch kernel
+// uses the same SSE2 intrinsics directly instead; SSE2 is always there on x64.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_BATCH_SSE2 1
+#endif
+
+// Structure-of-arrays input for TransformBatch::composeTRS(). Rotations are Euler
+// angles in degrees, applied X, then Y, then Z (the primitives' submit() order).
+struct TransformSoA {
+    std::vector<float> tx, ty, tz;
+    std::vector<float> rx, ry, rz;
+    std::vector<float> sx, sy, sz;
+
+    size_t size() const { return tx.size(); }
+
+    void push_back(glm::vec3 t, glm::vec3 r, glm::vec3 s) {
+        tx.push_back(t.x); ty.push_back(t.y); tz.push_back(t.z);
+        rx.push_back(r.x); ry.push_back(r.y); rz.push_back(r.z);
+        sx.push_back(s.x); sy.push_back(s.y); sz.push_back(s.z);
+    }
+
+    void clear() {
+        for (std::vector<float>* v : { &tx, &ty, &tz, &rx, &ry, &rz, &sx, &sy, &sz })
+            v->clear();
+    }
+};
+
+// Builds translate * rotateX * rotateY * rotateZ * scale in closed form: the
+// rotation block is written out from the six sines and cosines and the scale
+// folded into its columns, instead of five generic 4x4 multiplies.
+namespace TransformBatch {
+
+    inline glm::mat4 composeTRS(glm::vec3 t, glm::vec3 rotationDegrees, glm::vec3 s) {
+        glm::vec3 r = glm::radians(rotationDegrees);
+        float sx = std::sin(r.x), cx = std::cos(r.x);
+        float sy = std::sin(r.y), cy = std::cos(r.y);
+        float sz = std::sin(r.z), cz = std::cos(r.z);
+
+        glm::mat4 m;
+        m[0] = glm::vec4(cy * cz, sx * sy * cz + cx * sz, sx * sz - cx * sy * cz, 0.0f) * s.x;
+        m[1] = glm::vec4(-cy * sz, cx * cz - sx * sy * sz, cx * sy * sz + sx * cz, 0.0f) * s.y;
+        m[2] = glm::vec4(sy, -sx * cy, cx * cy, 0.0f) * s.z;
+        m[3] = glm::vec4(t, 1.0f);
+        return m;
+    }
+
+#ifdef TRANSFORM_BATCH_SSE2
+    namespace detail {
+        // sin and cos of four angles (radians) at once; Cephes single precision
+        // polynomials after reduction to [-pi/4, pi/4], about 1 ulp up to |x| < 8192
+        inline void sincos4(__m128 x, __m128& sinOut, __m128& cosOut) {
+            const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+            __m128 signSin = _mm_and_ps(x, signMask);
+            x = _mm_andnot_ps(signMask, x);
+
+            // Octant index, rounded up to even
+            __m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+            j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+            __m128 y = _mm_cvtepi32_ps(j);
+
+            // Quadrant 2 and 3 flip the sign of sin, quadrant 1 and 2 the sign of cos
+            __m128 flipSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+            __m128 flipCos = _mm_castsi128_ps(_mm_slli_epi32(
+                _mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+            // Odd quadrants swap the sin and cos polynomials
+            __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+            // Extended precision x - y * pi/4
+            x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+            x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+            x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+            __m128 z = _mm_mul_ps(x, x);
+
+            __m128 c = _mm_set1_ps(2.443315711809948e-5f);
+            c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(-1.388731625493765e-3f));
+            c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+            c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+            c = _mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+            c = _mm_add_ps(c, _mm_set1_ps(1.0f));
+
+            __m128 s = _mm_set1_ps(-1.9515295891e-4f);
+            s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(8.3321608736e-3f));
+            s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+            s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+            __m128 sinPoly = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+            __m128 cosPoly = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+            sinOut = _mm_xor_ps(sinPoly, _mm_xor_ps(signSin, flipSin));
+            cosOut = _mm_xor_ps(cosPoly, flipCos);
+        }
+
+        // Transpose one column of four matrices from lanes into place
+        inline void storeColumn(glm::mat4* out, int column, __m128 x, __m128 y, __m128 z, __m128 w) {
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps(&out[0][column][0], x);
+            _mm_storeu_ps(&out[1][column][0], y);
+            _mm_storeu_ps(&out[2][column][0], z);
+            _mm_storeu_ps(&out[3][column][0], w);
+        }
+    }
+#endif
+
+    // Compose in.size() model matrices into out. The SSE2 path handles four
+    // transforms per iteration, one per lane; the remainder goes through the scalar path.
+    inline void composeTRS(const TransformSoA& in, glm::mat4* out) {
+        size_t count = in.size();
+        size_t i = 0;
+
+#ifdef TRANSFORM_BATCH_SSE2
+        const __m128 toRadians = _mm_set1_ps(0.01745329251994329577f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 sx, cx, sy, cy, sz, cz;
+            detail::sincos4(_mm_mul_ps(_mm_loadu_ps(&in.rx[i]), toRadians), sx, cx);
+            detail::sincos4(_mm_mul_ps(_mm_loadu_ps(&in.ry[i]), toRadians), sy, cy);
+            detail::sincos4(_mm_mul_ps(_mm_loadu_ps(&in.rz[i]), toRadians), sz, cz);
+
+            __m128 sxsy = _mm_mul_ps(sx, sy);
+            __m128 cxsy = _mm_mul_ps(cx, sy);
+
+            __m128 scale = _mm_loadu_ps(&in.sx[i]);
+            detail::storeColumn(out + i, 0,
+                _mm_mul_ps(_mm_mul_ps(cy, cz), scale),
+                _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sxsy, cz), _mm_mul_ps(cx, sz)), scale),
+                _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sx, sz), _mm_mul_ps(cxsy, cz)), scale),
+                zero);
+
+            scale = _mm_loadu_ps(&in.sy[i]);
+            detail::storeColumn(out + i, 1,
+                _mm_mul_ps(_mm_sub_ps(zero, _mm_mul_ps(cy, sz)), scale),
+                _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cx, cz), _mm_mul_ps(sxsy, sz)), scale),
+                _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cxsy, sz), _mm_mul_ps(sx, cz)), scale),
+                zero);
+
+            scale = _mm_loadu_ps(&in.sz[i]);
+            detail::storeColumn(out + i, 2,
+                _mm_mul_ps(sy, scale),
+                _mm_mul_ps(_mm_sub_ps(zero, _mm_mul_ps(sx, cy)), scale),
+                _mm_mul_ps(_mm_mul_ps(cx, cy), scale),
+                zero);
+
+            detail::storeColumn(out + i, 3,
+                _mm_loadu_ps(&in.tx[i]), _mm_loadu_ps(&in.ty[i]), _mm_loadu_ps(&in.tz[i]), one);
+        }
+#endif
+
+        for (; i < count; i++) {
+            out[i] = composeTRS(glm::vec3(in.tx[i], in.ty[i], in.tz[i]),
+                glm::vec3(in.rx[i], in.ry[i], in.rz[i]),
+                glm::vec3(in.sx[i], in.sy[i], in.sz[i]));
+        }
+    }
+
+    inline void composeTRS(const TransformSoA& in, std::vector<glm::mat4>& out) {
+        out.resize(in.size());
+        composeTRS(in, out.data());
+    }
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef VERTEX_COMPRESSION_H
+#define VERTEX_COMPRESSION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Compact vertex attributes for the GPU copies of static meshes. The vertex
+// fetch unpacks them: glVertexAttribPointer with normalized = GL_TRUE turns a
+// signed integer c of b bits into max(c / (2^(b-1) - 1), -1).
+//
+// Positions are 16-bit normalized against the mesh's bounding box, so each
+// axis is off by at most half a step, a 65534th of the box. Normals are
+// octahedral-encoded: the unit sphere is projected onto the octahedron
+// |x| + |y| + |z| = 1, whose lower half is folded out over the corners of the
+// square, and the two square coordinates are stored as 8-bit normalized integers.
+namespace VertexCompression {
+    constexpr float SNORM16_MAX = 32767.0f;
+    constexpr float SNORM8_MAX = 127.0f;
+
+    // Worst normal direction error Error::acceptable() lets through
+    constexpr float MAX_NORMAL_ERROR_DEGREES = 1.0f;
+
+    // Maps stored positions in [-1, 1] onto a mesh's box
+    struct Decode {
+        glm::vec3 scale = glm::vec3(1.0f);
+        glm::vec3 offset = glm::vec3(0.0f);
+
+        glm::vec3 apply(const glm::vec3& stored) const { return offset + scale * stored; }
+    };
+
+    // The box around 'count' positions 'stride' floats apart. Flat axes keep a
+    // scale of 1; their positions all store as 0.
+    inline Decode fit(const float* positions, size_t count, size_t stride) {
+        Decode decode;
+        if (count == 0) return decode;
+        glm::vec3 low(positions[0], positions[1], positions[2]), high = low;
+        for (size_t i = 1; i < count; i++) {
+            const float* p = positions + i * stride;
+            low = glm::min(low, glm::vec3(p[0], p[1], p[2]));
+            high = glm::max(high, glm::vec3(p[0], p[1], p[2]));
+        }
+        decode.offset = (low + high) * 0.5f;
+        for (int axis = 0; axis < 3; axis++) {
+            float half = (high[axis] - low[axis]) * 0.5f;
+            decode.scale[axis] = half > 0.0f ? half : 1.0f;
+        }
+        return decode;
+    }
+
+    inline int16_t toSnorm16(float v) { return (int16_t)std::lround(std::clamp(v, -1.0f, 1.0f) * SNORM16_MAX); }
+    inline int8_t toSnorm8(float v) { return (int8_t)std::lround(std::clamp(v, -1.0f, 1.0f) * SNORM8_MAX); }
+    inline float fromSnorm16(int16_t c) { return std::max(c / SNORM16_MAX, -1.0f); }
+    inline float fromSnorm8(int8_t c) { return std::max(c / SNORM8_MAX, -1.0f); }
+
+    inline void packPosition(const glm::vec3& position, const Decode& decode, int16_t out[3]) {
+        glm::vec3 stored = (position - decode.offset) / decode.scale;
+        for (int axis = 0; axis < 3; axis++) out[axis] = toSnorm16(stored[axis]);
+    }
+
+    inline glm::vec3 unpackPosition(const int16_t in[3], const Decode& decode) {
+        return decode.apply(glm::vec3(fromSnorm16(in[0]), fromSnorm16(in[1]), fromSnorm16(in[2])));
+    }
+
+    // Point of the octahedron square for a unit vector
+    inline glm::vec2 octEncode(const glm::vec3& n) {
+        float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (sum == 0.0f) return glm::vec2(0.0f);
+        glm::vec2 e(n.x / sum, n.y / sum);
+        if (n.z < 0.0f) {
+            glm::vec2 sign(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+            e = (1.0f - glm::abs(glm::vec2(e.y, e.x))) * sign;
+        }
+        return e;
+    }
+
+    // The same steps as octDecode() in the vertex shaders
+    inline glm::vec3 octDecode(const glm::vec2& e) {
+        glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+        if (n.z < 0.0f) {
+            glm::vec2 sign(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+            glm::vec2 folded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * sign;
+            n.x = folded.x;
+            n.y = folded.y;
+        }
+        return glm::normalize(n);
+    }
+
+    inline glm::vec3 unpackNormal(const int8_t in[2]) {
+        return octDecode(glm::vec2(fromSnorm8(in[0]), fromSnorm8(in[1])));
+    }
+
+    // Rounding each coordinate to its nearest step can land up to twice as far
+    // from the normal as the best of the four surrounding grid points, so all
+    // four are decoded and the closest kept
+    inline void packNormal(const glm::vec3& normal, int8_t out[2]) {
+        glm::vec3 n = glm::normalize(normal);
+        glm::vec2 e = octEncode(n) * SNORM8_MAX;
+        float best = -2.0f;
+        for (int i = 0; i < 4; i++) {
+            int8_t candidate[2] = {
+                (int8_t)std::clamp((i & 1) ? std::ceil(e.x) : std::floor(e.x), -SNORM8_MAX, SNORM8_MAX),
+                (int8_t)std::clamp((i & 2) ? std::ceil(e.y) : std::floor(e.y), -SNORM8_MAX, SNORM8_MAX)
+            };
+            float match = glm::dot(unpackNormal(candidate), n);
+            if (match > best) {
+                best = match;
+                out[0] = candidate[0];
+                out[1] = candidate[1];
+            }
+        }
+    }
+
+    // Worst error over everything packed so far, measured by decoding what was stored
+    struct Error {
+        float position = 0.0f;   // object units
+        float steps = 0.0f;      // position error in 16-bit steps of its axis
+        float normalDegrees = 0.0f;
+
+        void addPosition(const glm::vec3& original, const int16_t packed[3], const Decode& decode) {
+            glm::vec3 error = glm::abs(unpackPosition(packed, decode) - original);
+            for (int axis = 0; axis < 3; axis++) {
+                position = std::max(position, error[axis]);
+                steps = std::max(steps, error[axis] / decode.scale[axis] * SNORM16_MAX);
+            }
+        }
+
+        void addNormal(const glm::vec3& original, const int8_t packed[2]) {
+            float cosine = glm::dot(unpackNormal(packed), glm::normalize(original));
+            float degrees = glm::degrees(std::acos(std::clamp(cosine, -1.0f, 1.0f)));
+            normalDegrees = std::max(normalDegrees, degrees);
+        }
+
+        // Positions within one step (half a step of rounding plus float error)
+        // and normals within MAX_NORMAL_ERROR_DEGREES
+        bool acceptable() const { return steps <= 1.0f && normalDegrees <= MAX_NORMAL_ERROR_DEGREES; }
+    };
+}
+
+#endif
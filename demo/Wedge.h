@@ -5,40 +5,45 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include "Shader.h"
+#include "MeshCache.h"
+#include "TransformBatch.h"
 
 // A triangular prism / wedge shape - great for futuristic angular designs
 class Wedge {
 public:
     Wedge() {
-        setUpWedge();
+        mesh = MeshCache::get().acquire(MeshKey(MESH_WEDGE), buildWedge);
     }
 
     ~Wedge() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        MeshCache::get().release(mesh);
     }
 
-    void draw(Shader& shader, glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
-        glm::mat4 t = glm::translate(parentModel, glm::vec3(tx, ty, tz));
-        glm::mat4 rX = glm::rotate(t, glm::radians(rx), glm::vec3(1.0f, 0.0f, 0.0f));
-        glm::mat4 rY = glm::rotate(rX, glm::radians(ry), glm::vec3(0.0f, 1.0f, 0.0f));
-        glm::mat4 rZ = glm::rotate(rY, glm::radians(rz), glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::mat4 m = glm::scale(rZ, glm::vec3(sx, sy, sz));
+    // Draw with explicit transformations (single instance, drawn immediately)
+    void draw(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+        submit(parentModel, tx, ty, tz, rx, ry, rz, sx, sy, sz, colorVec);
+        flush();
+    }
+
+    // Queue one instance; nothing is drawn until flush()
+    void submit(glm::mat4 parentModel, float tx, float ty, float tz, float rx, float ry, float rz, float sx, float sy, float sz, glm::vec3 colorVec) {
+        glm::mat4 m = parentModel * TransformBatch::composeTRS(glm::vec3(tx, ty, tz), glm::vec3(rx, ry, rz), glm::vec3(sx, sy, sz));
 
-        shader.setMat4("model", m);
-        shader.setVec3("customColor", colorVec);
+        mesh->add(m, colorVec);
+    }
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 24, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    // Draw every queued instance with one instanced call
+    void flush() {
+        mesh->flush();
     }
 
+    // Shared mesh, for scene graph parts that queue their own instances
+    Mesh* getMesh() const { return mesh; }
+
 private:
-    unsigned int VAO, VBO, EBO;
+    Mesh* mesh;
 
-    void setUpWedge() {
+    static void buildWedge(MeshData& data) {
         // Triangular prism centered at origin
         // Triangle in XY plane, extruded along Z
         float vertices[] = {
@@ -65,21 +70,8 @@ private:
             1, 4, 5, 5, 2, 1
         };
 
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glBindVertexArray(0);
+        data.vertices.assign(vertices, vertices + sizeof(vertices) / sizeof(float));
+        data.indices.assign(indices, indices + sizeof(indices) / sizeof(unsigned int));
     }
 };
 
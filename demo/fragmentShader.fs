@@ -1,11 +1,11 @@
 #version 330 core
 out vec4 FragColor;
 
-uniform vec3 customColor;
+in vec3 instanceColor;
 uniform bool lightOn;
 
 void main()
 {
-    vec3 resultColor = customColor;
+    vec3 resultColor = instanceColor;
     FragColor = vec4(resultColor, 1.0f);
 }
\ No newline at end of file
@@ -4,10 +4,21 @@
 #include "Ship.h"
 #include "CockpitInterior.h"
 #include "AppConfig.h"
+#include "TransformBatch.h"
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
+#include "SoftwareRasterizer.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
 
 // --- Globals ---
 // Isometric view camera (external)
@@ -33,6 +44,87 @@ bool isIsometric = AppConfig::ViewMode::DEFAULT_ISOMETRIC;
 float cockpitLookYaw = 0.0f;
 float cockpitLookPitch = 0.0f;
 
+// Values before the last simulation tick; the render callback blends from these
+// to the current ones with Application::interpolationAlpha()
+glm::vec3 previousCameraPosition = camera.Position;
+float previousLookYaw = 0.0f;
+float previousLookPitch = 0.0f;
+
+// Extra ships drawn in the isometric view (--fleet N), in rows behind the first
+std::vector<glm::mat4> fleetModels;
+
+void buildFleet(int count) {
+    const int columns = 10;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 position((float)(i % columns - columns / 2) * 6.0f, 0.0f, -(float)(i / columns + 1) * 6.0f);
+        fleetModels.push_back(TransformBatch::composeTRS(position, glm::vec3(0.0f, (float)(i * 37 % 360), 0.0f), glm::vec3(1.0f)));
+    }
+}
+
+// Viewport clear colors
+const glm::vec3 EXTERNAL_CLEAR_COLOR(0.08f, 0.08f, 0.1f);
+const glm::vec3 COCKPIT_CLEAR_COLOR(0.02f, 0.02f, 0.05f);
+
+// Left viewport: isometric (orthographic) or perspective projection
+glm::mat4 externalProjection(float aspect) {
+    if (isIsometric) {
+        float scale = AppConfig::Projection::ORTHO_SCALE;
+        return glm::ortho(
+            -scale * aspect, scale * aspect,
+            -scale, scale,
+            AppConfig::Projection::NEAR_PLANE,
+            AppConfig::Projection::FAR_PLANE
+        );
+    }
+    return glm::perspective(
+        glm::radians(camera.Zoom),
+        aspect,
+        AppConfig::Projection::NEAR_PLANE,
+        AppConfig::Projection::FAR_PLANE
+    );
+}
+
+// Left viewport camera, 'alpha' of the way from the previous tick to this one
+glm::mat4 externalView(float alpha) {
+    BasicCamera shownCamera = camera;
+    shownCamera.Position = glm::mix(previousCameraPosition, camera.Position, alpha);
+    return shownCamera.GetViewMatrix();
+}
+
+// Cockpit Perspective Projection (wider FOV for immersion)
+glm::mat4 cockpitProjection(float aspect) {
+    float cockpitFOV = 75.0f;
+    return glm::perspective(
+        glm::radians(cockpitFOV),
+        aspect,
+        0.01f,  // Near plane very close for cockpit
+        50.0f
+    );
+}
+
+// Cockpit View - First person inside the ship
+glm::mat4 cockpitView(float alpha) {
+    glm::vec3 cockpitPos = AppConfig::Camera::COCKPIT_POSITION;
+
+    // Calculate look direction from yaw and pitch
+    float lookYaw = glm::mix(previousLookYaw, cockpitLookYaw, alpha);
+    float lookPitch = glm::mix(previousLookPitch, cockpitLookPitch, alpha);
+    float yaw = glm::radians(AppConfig::Camera::COCKPIT_YAW + lookYaw);
+    float pitch = glm::radians(AppConfig::Camera::COCKPIT_PITCH + lookPitch);
+
+    glm::vec3 cockpitFront;
+    cockpitFront.x = cos(yaw) * cos(pitch);
+    cockpitFront.y = sin(pitch);
+    cockpitFront.z = sin(yaw) * cos(pitch);
+    cockpitFront = glm::normalize(cockpitFront);
+
+    return glm::lookAt(
+        cockpitPos,
+        cockpitPos + cockpitFront,
+        glm::vec3(0.0f, 1.0f, 0.0f)
+    );
+}
+
 // Input handling function
 void processInput(GLFWwindow* window, float deltaTime) {
     if (glfwGetKey(window, AppConfig::Input::KEY_EXIT) == GLFW_PRESS)
@@ -105,16 +197,378 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
         camera.Zoom = AppConfig::Camera::ZOOM_MAX;
 }
 
-int main() {
+// Milliseconds taken by 'repeats' runs of work()
+template <typename Work>
+double timeRepeated(int repeats, Work work) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+        work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Compare the translate -> rotate x3 -> scale chain used by the primitives with the
+// closed-form and SSE batch kernels of TransformBatch.h (--bench-transforms)
+void runTransformBenchmark() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f), angle(-180.0f, 180.0f), scale(0.1f, 2.0f);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "transforms   glm chain   closed form   SSE batch   speedup   max error" << std::endl;
+
+    for (size_t count : { (size_t)1000, (size_t)100000, (size_t)1000000 }) {
+        TransformSoA soa;
+        for (size_t i = 0; i < count; i++) {
+            soa.push_back(glm::vec3(position(rng), position(rng), position(rng)),
+                glm::vec3(angle(rng), angle(rng), angle(rng)),
+                glm::vec3(scale(rng), scale(rng), scale(rng)));
+        }
+
+        std::vector<glm::mat4> chain(count), closed(count), batch(count);
+        int repeats = (int)std::max((size_t)1, (size_t)4000000 / count);
+
+        double chainMs = timeRepeated(repeats, [&]() {
+            for (size_t i = 0; i < count; i++) {
+                glm::mat4 t = glm::translate(glm::mat4(1.0f), glm::vec3(soa.tx[i], soa.ty[i], soa.tz[i]));
+                glm::mat4 rX = glm::rotate(t, glm::radians(soa.rx[i]), glm::vec3(1.0f, 0.0f, 0.0f));
+                glm::mat4 rY = glm::rotate(rX, glm::radians(soa.ry[i]), glm::vec3(0.0f, 1.0f, 0.0f));
+                glm::mat4 rZ = glm::rotate(rY, glm::radians(soa.rz[i]), glm::vec3(0.0f, 0.0f, 1.0f));
+                chain[i] = glm::scale(rZ, glm::vec3(soa.sx[i], soa.sy[i], soa.sz[i]));
+            }
+        });
+        double closedMs = timeRepeated(repeats, [&]() {
+            for (size_t i = 0; i < count; i++) {
+                closed[i] = TransformBatch::composeTRS(glm::vec3(soa.tx[i], soa.ty[i], soa.tz[i]),
+                    glm::vec3(soa.rx[i], soa.ry[i], soa.rz[i]), glm::vec3(soa.sx[i], soa.sy[i], soa.sz[i]));
+            }
+        });
+        double batchMs = timeRepeated(repeats, [&]() {
+            TransformBatch::composeTRS(soa, batch.data());
+        });
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++)
+                    maxError = std::max(maxError, std::max(std::abs(batch[i][c][r] - chain[i][c][r]),
+                        std::abs(closed[i][c][r] - chain[i][c][r])));
+
+        // Nanoseconds per transform
+        double perTransform = 1e6 / ((double)count * repeats);
+        std::cout << std::setw(10) << count
+            << std::setw(10) << chainMs * perTransform << " ns"
+            << std::setw(11) << closedMs * perTransform << " ns"
+            << std::setw(9) << batchMs * perTransform << " ns"
+            << std::setw(9) << chainMs / batchMs << "x"
+            << std::setw(12) << std::scientific << std::setprecision(1) << maxError
+            << std::fixed << std::setprecision(2) << std::endl;
+    }
+}
+
+// Place the parts of 'ships' ships, like Ship::recordFleet(), on 1, 2, 4...
+// threads up to twice the core count (--bench-jobs)
+void runJobBenchmark() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f), angle(-180.0f, 180.0f), scale(0.1f, 2.0f);
+
+    const size_t parts = 24, ships = 10000;
+    std::vector<glm::mat4> partModels(parts), shipModels(ships), instances(parts * ships);
+    for (glm::mat4& m : partModels)
+        m = TransformBatch::composeTRS(glm::vec3(position(rng)), glm::vec3(angle(rng)), glm::vec3(scale(rng)));
+    for (glm::mat4& m : shipModels)
+        m = TransformBatch::composeTRS(glm::vec3(position(rng), 0.0f, position(rng)), glm::vec3(0.0f, angle(rng), 0.0f), glm::vec3(1.0f));
+
+    JobSystem& jobs = JobSystem::get();
+    int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+    int restoreWorkers = jobs.workerCount();
+
+    std::cout << ships << " ships x " << parts << " parts, " << cores << " hardware threads" << std::endl;
+    std::cout << "threads   ms/frame   speedup" << std::endl;
+    double oneThreadMs = 0.0;
+    for (int threads = 1; threads <= std::max(2 * cores, 4); threads *= 2) {
+        jobs.setWorkerCount(threads - 1);
+        double ms = timeRepeated(20, [&]() {
+            jobs.parallelFor(0, ships, 16, [&](size_t begin, size_t end) {
+                for (size_t ship = begin; ship < end; ship++)
+                    for (size_t part = 0; part < parts; part++)
+                        instances[ship * parts + part] = shipModels[ship] * partModels[part];
+            });
+        }) / 20.0;
+        if (threads == 1) oneThreadMs = ms;
+
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(7) << threads
+            << std::setw(11) << ms
+            << std::setw(9) << oneThreadMs / ms << "x"
+            << (threads > cores ? "  (more threads than cores)" : "") << std::endl;
+    }
+    jobs.setWorkerCount(restoreWorkers);
+}
+
+// Rasterize the instances flush() captured, with vertexShader.vs and
+// fragmentShader.fs (the instance color) done in C++
+void drawCaptured(SoftwareRasterizer& raster, const std::vector<CapturedDraw>& captured, const glm::mat4& viewProjection) {
+    struct Instance {
+        const MeshRange* range;
+        const InstanceData* data;
+    };
+    std::vector<Instance> instances;
+    for (const CapturedDraw& draw : captured)
+        for (const InstanceData& data : draw.instances)
+            instances.push_back({ &draw.range, &data });
+
+    const float* vertices = MeshArena::get().vertexData().data();
+    const unsigned int* indices = MeshArena::get().indexData().data();
+    raster.setVaryingCount(0);
+    raster.draw(instances.size(),
+        [&](size_t i, SoftwareRasterizer::Batch& batch) {
+            const MeshRange& range = *instances[i].range;
+            glm::mat4 mvp = viewProjection * instances[i].data->model;
+            batch.indexed(vertices, 3, indices, range.firstIndex, range.indexCount, range.baseVertex, (uint32_t)i,
+                [&](const float* in, SoftwareRasterizer::Vertex& out) {
+                    out.position = mvp * glm::vec4(in[0], in[1], in[2], 1.0f);
+                });
+        },
+        [&](uint32_t i, const float*) { return instances[i].data->color; });
+}
+
+// --software [frames]: draw both viewports on the CPU, without a window or GL
+// context, and write the last frame to the --frame-out path
+void runSoftware(int frames, const std::string& imagePath) {
+    const int width = AppConfig::Window::WIDTH, height = AppConfig::Window::HEIGHT;
+    const int halfWidth = width / 2;
+    float aspect = (float)halfWidth / (float)height;
+
+    Ship ship;
+    CockpitInterior cockpit;
+    SoftwareRasterizer raster;
+    raster.resize(width, height);
+    std::vector<CapturedDraw> captured;
+    MeshArena::get().capture(&captured);
+
+    std::vector<double> frameTimes;
+    for (int frame = 0; frame < frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        raster.resetStats();
+
+        raster.setViewport(0, 0, halfWidth, height);
+        raster.clear(EXTERNAL_CLEAR_COLOR);
+        captured.clear();
+        glm::mat4 projection = externalProjection(aspect), view = externalView(1.0f);
+        ship.setLodView(MeshLod::View(projection, view, (float)height));
+        ship.record(glm::mat4(1.0f));
+        if (!fleetModels.empty()) ship.recordFleet(fleetModels);
+        ship.flush();
+        drawCaptured(raster, captured, projection * view);
+
+        raster.setViewport(halfWidth, 0, halfWidth, height);
+        raster.clear(COCKPIT_CLEAR_COLOR);
+        captured.clear();
+        cockpit.record(glm::mat4(1.0f));
+        cockpit.flush();
+        drawCaptured(raster, captured, cockpitProjection(aspect) * cockpitView(1.0f));
+
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    MeshArena::get().capture(nullptr);
+
+    double total = 0.0;
+    for (double t : frameTimes) total += t;
+    const SoftwareRasterizer::Stats& stats = raster.stats();
+    std::cout << "Software renderer: " << frames << " frames at " << width << "x" << height << " on "
+        << JobSystem::get().workerCount() + 1 << " threads, frame time avg " << std::fixed << std::setprecision(2)
+        << total / frames << " ms, min " << *std::min_element(frameTimes.begin(), frameTimes.end()) << " ms" << std::endl;
+    std::cout << "Last frame: " << stats.triangles << " triangles (" << stats.clipped << " clipped), "
+        << stats.setUp << " rasterized in " << stats.binEntries << " tile bins, "
+        << stats.blocksSkipped << " blocks skipped by hierarchical Z, " << stats.fragments << " fragments shaded" << std::endl;
+    if (!raster.writeImage(imagePath))
+        std::cout << "Failed to write " << imagePath << std::endl;
+}
+
+// Triangles and CPU raster time of the isometric view with and without
+// levels of detail, zoomed out further and further so the ships get small (--bench-lod)
+void runLodBenchmark() {
+    const int width = AppConfig::Window::WIDTH / 2, height = AppConfig::Window::HEIGHT;
+    float aspect = (float)width / (float)height;
+    if (fleetModels.empty()) buildFleet(400);
+
+    Ship ship;
+    SoftwareRasterizer raster;
+    raster.resize(width, height);
+    raster.setViewport(0, 0, width, height);
+    std::vector<CapturedDraw> captured;
+    MeshArena::get().capture(&captured);
+
+    // Draw the ship and fleet 'repeats' times; milliseconds per frame
+    auto drawFleet = [&](float orthoScale, bool lod, int repeats) {
+        MeshLod::enabled() = lod;
+        glm::mat4 projection = glm::ortho(-orthoScale * aspect, orthoScale * aspect, -orthoScale, orthoScale,
+            AppConfig::Projection::NEAR_PLANE, AppConfig::Projection::FAR_PLANE);
+        glm::mat4 view = externalView(1.0f);
+        ship.setLodView(MeshLod::View(projection, view, (float)height));
+        return timeRepeated(repeats, [&]() {
+            raster.resetStats();
+            raster.clear(EXTERNAL_CLEAR_COLOR);
+            captured.clear();
+            ship.record(glm::mat4(1.0f));
+            ship.recordFleet(fleetModels);
+            ship.flush();
+            drawCaptured(raster, captured, projection * view);
+        }) / repeats;
+    };
+
+    std::cout << 1 + fleetModels.size() << " ships, isometric view " << width << "x" << height
+        << ", chord error below " << MeshLod::MAX_ERROR_PIXELS << " px" << std::endl;
+    std::cout << "ortho scale   full triangles   LOD triangles   saved   full ms   LOD ms   pixels over 8" << std::endl;
+    for (float orthoScale : { AppConfig::Projection::ORTHO_SCALE, 15.0f, 40.0f }) {
+        drawFleet(orthoScale, false, 1);
+        double fullMs = drawFleet(orthoScale, false, 5);
+        size_t fullTriangles = raster.stats().triangles;
+        std::vector<glm::u8vec3> fullImage;
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                fullImage.push_back(raster.pixel(x, y));
+
+        drawFleet(orthoScale, true, 1);
+        double lodMs = drawFleet(orthoScale, true, 5);
+        size_t lodTriangles = raster.stats().triangles;
+        size_t differing = 0;
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                glm::ivec3 d = glm::abs(glm::ivec3(raster.pixel(x, y)) - glm::ivec3(fullImage[(size_t)y * width + x]));
+                if (std::max({ d.x, d.y, d.z }) > 8) differing++;
+            }
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+            << std::setw(11) << orthoScale
+            << std::setw(17) << fullTriangles
+            << std::setw(16) << lodTriangles
+            << std::setw(7) << 100.0 * (1.0 - (double)lodTriangles / fullTriangles) << "%"
+            << std::setprecision(2)
+            << std::setw(10) << fullMs
+            << std::setw(9) << lodMs
+            << std::setw(16) << differing << std::endl;
+    }
+    MeshLod::enabled() = true;
+    MeshArena::get().capture(nullptr);
+}
+
+// Vertex memory of every ship mesh as floats and packed, and the worst
+// position error of the packed copy (--vertex-report); false if it is over a step
+bool runVertexReport() {
+    Ship ship;
+    const MeshArena& arena = MeshArena::get();
+    const VertexCompression::Error& error = arena.compressionError();
+    std::cout << arena.vertexCount() << " vertices: " << arena.floatVertexBytes() << " bytes as floats, "
+        << arena.packedVertexBytes() << " bytes packed (" << std::fixed << std::setprecision(1)
+        << 100.0 * arena.packedVertexBytes() / arena.floatVertexBytes() << "%)" << std::endl;
+    std::cout << std::setprecision(7) << "max position error " << error.position << " units, "
+        << std::setprecision(3) << error.steps << " steps" << std::endl;
+    bool passed = error.acceptable();
+    std::cout << (passed ? "Vertex compression within tolerance" : "Vertex compression error too large") << std::endl;
+    return passed;
+}
+
+void writeTrace(const char* path) {
+    if (!path) return;
+    if (Profiler::get().writeChromeTrace(path))
+        std::cout << "Trace written to " << path << " (open in chrome://tracing or ui.perfetto.dev)" << std::endl;
+    else
+        std::cout << "Failed to write " << path << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const char* tracePath = nullptr;
+    const char* gpuLogPath = nullptr;
+    double tickRate = 0.0;
+    int softwareFrames = 0;
+    bool lodBenchmark = false;
+    for (int i = 1; i < argc; i++) {
+        // Micro-benchmark mode runs without opening a window
+        if (strcmp(argv[i], "--bench-transforms") == 0) {
+            runTransformBenchmark();
+            return 0;
+        }
+        if (strcmp(argv[i], "--bench-jobs") == 0) {
+            runJobBenchmark();
+            return 0;
+        }
+        // Check the packed vertex buffer against the float meshes
+        if (strcmp(argv[i], "--vertex-report") == 0) {
+            return runVertexReport() ? 0 : 1;
+        }
+        // Runs once the other options (--fleet, --threads) are read
+        if (strcmp(argv[i], "--bench-lod") == 0) {
+            lodBenchmark = true;
+        }
+        // Draw N more ships; their part matrices are computed on all cores
+        if (strcmp(argv[i], "--fleet") == 0 && i + 1 < argc) {
+            buildFleet(atoi(argv[++i]));
+        }
+        // Threads for per-frame CPU work, including the one submitting it (default: one per core)
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            JobSystem::get().setWorkerCount(std::max(1, atoi(argv[++i])) - 1);
+        }
+        // Record profiler zones and save them as a Chrome trace on exit
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+            Profiler::setEnabled(true);
+            Profiler::get().setThreadName("main");
+        }
+        // Time each render pass on the GPU; bars in the corner, times in the title
+        if (strcmp(argv[i], "--gpu-timers") == 0) {
+            GpuTimer::setEnabled(true);
+        }
+        // Log every resolved pass as CSV (implies --gpu-timers)
+        if (strcmp(argv[i], "--gpu-log") == 0 && i + 1 < argc) {
+            gpuLogPath = argv[++i];
+            GpuTimer::setEnabled(true);
+        }
+        // Simulation ticks per second (default 60), independent of the frame rate
+        if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            tickRate = atof(argv[++i]);
+        }
+        // Always compile shaders from source instead of using shader_cache/
+        if (strcmp(argv[i], "--no-shader-cache") == 0) {
+            ProgramCache::enabled() = false;
+        }
+        // Draw the round parts of the ship at full detail however small they are
+        if (strcmp(argv[i], "--no-lod") == 0) {
+            MeshLod::enabled() = false;
+        }
+        // Rasterize on the CPU, without a window or GL context
+        if (strcmp(argv[i], "--software") == 0) {
+            softwareFrames = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (softwareFrames > 0) i++;
+            else softwareFrames = 1;
+        }
+    }
+
+    if (lodBenchmark) {
+        runLodBenchmark();
+        return 0;
+    }
+
+    if (softwareFrames > 0) {
+        runSoftware(softwareFrames, HeadlessOptions::parse(argc, argv).imagePath);
+        writeTrace(tracePath);
+        return 0;
+    }
+
     Application app(
         AppConfig::Window::WIDTH, 
         AppConfig::Window::HEIGHT, 
         AppConfig::Window::TITLE
     );
 
-    if (!app.initialize()) {
+    // --headless [frames] renders offscreen and writes timings and the last frame
+    if (!app.initialize(HeadlessOptions::parse(argc, argv))) {
         return -1;
     }
+    app.setTickRate(tickRate);
+    if (gpuLogPath && !GpuTimer::get().openLog(gpuLogPath)) {
+        std::cout << "Failed to open " << gpuLogPath << std::endl;
+    }
 
     // Set callbacks
     glfwSetCursorPosCallback(app.getWindow(), mouse_callback);
@@ -128,6 +582,10 @@ int main() {
         AppConfig::Shaders::VERTEX_SHADER, 
         AppConfig::Shaders::FRAGMENT_SHADER
     );
+    ProgramCache::printSummary();
+    // Resolved once; the render loop sets them per viewport by location
+    int projectionLocation = shader.uniform("projection");
+    int viewLocation = shader.uniform("view");
     Ship ship;
     CockpitInterior cockpit;
 
@@ -140,8 +598,11 @@ int main() {
             }
             glEnable(GL_SCISSOR_TEST);
         },
-        // Update
+        // Update (one fixed tick)
         [&](float deltaTime) {
+            previousCameraPosition = camera.Position;
+            previousLookYaw = cockpitLookYaw;
+            previousLookPitch = cockpitLookPitch;
             processInput(app.getWindow(), deltaTime);
         },
         // Render
@@ -149,91 +610,59 @@ int main() {
             unsigned int width = app.getWidth();
             unsigned int height = app.getHeight();
             unsigned int halfWidth = width / 2;
+            float aspect = (float)halfWidth / (float)height;
+            float alpha = app.interpolationAlpha();
 
             shader.use();
 
             // ==================== LEFT VIEWPORT: ISOMETRIC VIEW ====================
-            glViewport(0, 0, halfWidth, height);
-            glScissor(0, 0, halfWidth, height);
-            glClearColor(0.08f, 0.08f, 0.1f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            {
+                GPU_ZONE("isometric viewport");
+                glViewport(0, 0, halfWidth, height);
+                glScissor(0, 0, halfWidth, height);
+                glClearColor(EXTERNAL_CLEAR_COLOR.r, EXTERNAL_CLEAR_COLOR.g, EXTERNAL_CLEAR_COLOR.b, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            // Isometric Projection
-            glm::mat4 projection;
-            float aspect = (float)halfWidth / (float)height;
+                glm::mat4 projection = externalProjection(aspect);
+                glm::mat4 view = externalView(alpha);
+                shader.setMat4(projectionLocation, projection);
+                shader.setMat4(viewLocation, view);
 
-            if (isIsometric) {
-                float scale = AppConfig::Projection::ORTHO_SCALE;
-                projection = glm::ortho(
-                    -scale * aspect, scale * aspect, 
-                    -scale, scale, 
-                    AppConfig::Projection::NEAR_PLANE, 
-                    AppConfig::Projection::FAR_PLANE
-                );
-            }
-            else {
-                projection = glm::perspective(
-                    glm::radians(camera.Zoom), 
-                    aspect, 
-                    AppConfig::Projection::NEAR_PLANE, 
-                    AppConfig::Projection::FAR_PLANE
-                );
+                // Draw Ship (external view), and the fleet behind it
+                glm::mat4 model = glm::mat4(1.0f);
+                ship.setLodView(MeshLod::View(projection, view, (float)height));
+                if (fleetModels.empty()) {
+                    ship.draw(model);
+                }
+                else {
+                    ship.record(model);
+                    ship.recordFleet(fleetModels);
+                    ship.flush();
+                }
             }
-            shader.setMat4("projection", projection);
 
-            // Isometric View
-            glm::mat4 view = camera.GetViewMatrix();
-            shader.setMat4("view", view);
+            // ==================== RIGHT VIEWPORT: COCKPIT VIEW ====================
+            {
+                GPU_ZONE("cockpit viewport");
+                glViewport(halfWidth, 0, halfWidth, height);
+                glScissor(halfWidth, 0, halfWidth, height);
+                glClearColor(COCKPIT_CLEAR_COLOR.r, COCKPIT_CLEAR_COLOR.g, COCKPIT_CLEAR_COLOR.b, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            // Draw Ship (external view)
-            glm::mat4 model = glm::mat4(1.0f);
-            ship.draw(shader, model);
+                shader.setMat4(projectionLocation, cockpitProjection(aspect));
+                shader.setMat4(viewLocation, cockpitView(alpha));
 
-            // ==================== RIGHT VIEWPORT: COCKPIT VIEW ====================
-            glViewport(halfWidth, 0, halfWidth, height);
-            glScissor(halfWidth, 0, halfWidth, height);
-            glClearColor(0.02f, 0.02f, 0.05f, 1.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            // Cockpit Perspective Projection (wider FOV for immersion)
-            float cockpitFOV = 75.0f;
-            projection = glm::perspective(
-                glm::radians(cockpitFOV), 
-                aspect, 
-                0.01f,  // Near plane very close for cockpit
-                50.0f
-            );
-            shader.setMat4("projection", projection);
-
-            // Cockpit View - First person inside the ship
-            glm::vec3 cockpitPos = AppConfig::Camera::COCKPIT_POSITION;
-            
-            // Calculate look direction from yaw and pitch
-            float yaw = glm::radians(AppConfig::Camera::COCKPIT_YAW + cockpitLookYaw);
-            float pitch = glm::radians(AppConfig::Camera::COCKPIT_PITCH + cockpitLookPitch);
-            
-            glm::vec3 cockpitFront;
-            cockpitFront.x = cos(yaw) * cos(pitch);
-            cockpitFront.y = sin(pitch);
-            cockpitFront.z = sin(yaw) * cos(pitch);
-            cockpitFront = glm::normalize(cockpitFront);
-            
-            glm::mat4 cockpitView = glm::lookAt(
-                cockpitPos,
-                cockpitPos + cockpitFront,
-                glm::vec3(0.0f, 1.0f, 0.0f)
-            );
-            shader.setMat4("view", cockpitView);
-
-            // Draw Cockpit Interior
-            glm::mat4 cockpitModel = glm::mat4(1.0f);
-            cockpit.draw(shader, cockpitModel);
+                // Draw Cockpit Interior
+                glm::mat4 cockpitModel = glm::mat4(1.0f);
+                cockpit.draw(cockpitModel);
+            }
 
             // Reset scissor for next frame
             glScissor(0, 0, width, height);
         }
     );
 
+    writeTrace(tracePath);
     app.shutdown();
-    return 0;
+    return app.exitCode();
 }
@@ -1,11 +1,20 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in vec3 aPos;  // 16-bit normalized, in [-1, 1] over the mesh's box
+// Per-instance attributes (see InstanceBuffer.h)
+layout (location = 1) in mat4 aModel;
+layout (location = 5) in vec3 aColor;
+// Per-draw constants: aPos back to object space (see MeshArena.h)
+layout (location = 6) in vec3 aPositionScale;
+layout (location = 7) in vec3 aPositionOffset;
+
+out vec3 instanceColor;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    instanceColor = aColor;
+    vec3 position = aPositionOffset + aPositionScale * aPos;
+    gl_Position = projection * view * aModel * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+@echo off
+rem Headless regression check of every project: the last frame against
+rem golden\frame.png and the p95 frame time against golden\perf.json.
+rem Exits 1 if any project fails, so CI or a build step can stop on it.
+rem
+rem   regression.bat [options passed to every project]
+rem
+rem Build the projects first; CONFIGURATION picks x64\<CONFIGURATION>\ (default
+rem Debug). A missing golden\perf.json fails: frame times depend on the machine,
+rem so write the perf baselines once on the machine that runs the checks with
+rem   regression.bat --update-perf-baseline
+rem which still checks the committed golden images. Only rewrite those on purpose,
+rem after looking at the new frames, with --update-golden.
+setlocal
+if "%CONFIGURATION%"=="" set CONFIGURATION=Debug
+set ARGS=%*
+set FAILED=0
+
+call :run demo demo
+call :run Lab_1\Assignment Assignment
+call :run Lab_2\Assignment Assignment2
+call :run Lab_3\Assignment Assignment
+call :run Labtest\3D 3D
+
+if %FAILED%==0 (echo Regression checks passed) else (echo Regression checks FAILED)
+exit /b %FAILED%
+
+rem Run one project from its own directory (shaders and golden\ are relative)
+:run
+echo === %~1 ===
+pushd "%~dp0%~1"
+"x64\%CONFIGURATION%\%~2.exe" --regression --require-baseline %ARGS%
+if errorlevel 1 (
+    echo %~1: FAILED
+    set FAILED=1
+)
+popd
+exit /b 0
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Headless regression check of every project: the last frame against
+# golden/frame.png and the p95 frame time against golden/perf.json.
+# Exits 1 if any project fails, so CI or a build step can stop on it.
+#
+#   ./regression.sh [options passed to every project]
+#
+# Executables default to <project>/x64/$CONFIGURATION/<name> (Debug, with or
+# without .exe); DEMO_EXE, LAB1_EXE, LAB2_EXE, LAB3_EXE and LABTEST_EXE point
+# at other builds. A missing golden/perf.json fails: frame times depend on the
+# machine, so write the perf baselines once on the machine that runs the checks with
+#   ./regression.sh --update-perf-baseline
+# which still checks the committed golden images. Only rewrite those on purpose,
+# after looking at the new frames, with --update-golden.
+
+root=$(cd "$(dirname "$0")" && pwd)
+config=${CONFIGURATION:-Debug}
+failed=0
+
+# Run one project from its own directory (shaders and golden/ are relative)
+run() {
+    dir=$1
+    exe=$2
+    if [ -z "$exe" ]; then
+        exe="$root/$dir/x64/$config/$3"
+        [ -x "$exe" ] || exe="$exe.exe"
+    fi
+    shift 3
+    echo "=== $dir ==="
+    if ! (cd "$root/$dir" && "$exe" --regression --require-baseline "$@"); then
+        echo "$dir: FAILED"
+        failed=1
+    fi
+}
+
+run demo "$DEMO_EXE" demo "$@"
+run Lab_1/Assignment "$LAB1_EXE" Assignment "$@"
+run Lab_2/Assignment "$LAB2_EXE" Assignment2 "$@"
+run Lab_3/Assignment "$LAB3_EXE" Assignment "$@"
+run Labtest/3D "$LABTEST_EXE" 3D "$@"
+
+if [ $failed -eq 0 ]; then echo "Regression checks passed"; else echo "Regression checks FAILED"; fi
+exit $failed